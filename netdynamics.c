@@ -1,774 +1,7859 @@
-/****************************** Module Header ******************************\
-* Module Name:  netdynamics.c
-* Project:      NetDynamics
-* Copyright (c) 2019 Stanislav Denisov
-*
-* Data-oriented networking playground for the reliable UDP transports
-*
-* This source is subject to the Microsoft Public License.
-* See https://opensource.org/licenses/MS-PL
-* All other rights reserved.
-*
-* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
-* EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
-* WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
-\***************************************************************************/
-
-#include <math.h>
-#include "aws/common/clock.h" // https://github.com/awslabs/aws-c-common
-#include "aws/common/thread.h"
-#include "jemalloc/jemalloc.h" // https://github.com/jemalloc/jemalloc
-#include "raylib/raylib.h" // https://github.com/raysan5/raylib
-#include "enet/enet.h" // https://github.com/nxrighthere/ENet-CSharp
-#include "binn/binn.h" // https://github.com/liteserver/binn
-#include "ini/ini.h" // https://github.com/benhoyt/inih
-
-#define VERSION_MAJOR 1
-#define VERSION_MINOR 0
-#define VERSION_PATCH 9
-
-#define NET_TRANSPORT_HYPERNET 0
-#define NET_TRANSPORT_ENET 1
-
-#define NET_MAX_CLIENTS 32
-#define NET_MAX_CHANNELS 2
-#define NET_MAX_ENTITIES 100000
-#define NET_MAX_ENTITY_SPAWN 10
-#define NET_MAX_ENTITY_SPEED 80.0f
-
-#define NET_MESSAGE_SPAWN 0xA
-#define NET_MESSAGE_MOVE 0xB
-#define NET_MESSAGE_DESTROY 0xC
-
-typedef struct _Settings {
-	uint8_t headlessMode;
-	uint16_t resolutionWidth;
-	uint16_t resolutionHeight;
-	uint8_t framerateLimit;
-	uint8_t vsync;
-	uint8_t transport;
-	char* ip;
-	uint16_t port;
-	uint8_t sendRate;
-	uint32_t redundantBytes;
-} Settings;
-
-static uint8_t redundancyBuffer[1024 * 1024];
-
-static const Color colors[] = {
-	{ 250, 250, 250, 255 },
-	{ 255, 0, 90, 255 },
-	{ 94, 8, 255, 255 },
-	{ 0, 80, 255, 255 },
-	{ 0, 220, 255, 255 },
-	{ 255, 255, 14, 255 }
-};
-
-static Settings settings;
-
-static Font font;
-static const int fontSize = 25;
-static const int textureWidth = 32;
-static const int textureHeight = 32;
-
-static const char* status;
-static const char* error;
-
-#ifdef NETDYNAMICS_CLIENT
-	static bool connected;
-	static float worstLag;
-#elif NETDYNAMICS_SERVER
-	static uint32_t connected;
-#endif
-
-// ENet
-
-static ENetHost* enetHost;
-static ENetPeer* enetPeer;
-
-// Strings
-
-static const char* string_listening = "Listening for connections";
-static const char* string_connecting = "Connecting to server...";
-static const char* string_connected = "Connected to server";
-static const char* string_disconnected = "Disconnected from server";
-static const char* string_server_failed = "Server creation failed";
-static const char* string_client_failed = "Client creation failed";
-static const char* string_host_failed = "Host creation failed";
-static const char* string_address_failed = "Address assignment failed";
-static const char* string_listening_failed = "Server listening failed";
-static const char* string_connection_failed = "Connection failed";
-
-// Entities
-
-typedef uint32_t Entity;
-
-static Entity entity;
-
-// Components
-
-static Vector2* position;
-static Vector2* speed;
-static Color* color;
-static Texture2D texture;
-static Vector2* destination;
-
-// Systems
-
-#define ENTITIES_EXIST() color[0].a != 0
-
-#ifdef NETDYNAMICS_SERVER
-	inline static void entity_spawn(Vector2 positionComponent, uint32_t quantity) {
-		uint32_t entities = entity + quantity;
-
-		for (uint32_t i = entity; i < entities; i++) {
-			if (entity < NET_MAX_ENTITIES) {
-				entity++;
-				position[i] = positionComponent;
-				speed[i] = (Vector2){ (float)RayGetRandomValue(-300, 300) / 60.0f, (float)RayGetRandomValue(-300, 300) / 60.0f };
-				color[i] = colors[RayGetRandomValue(0, sizeof(colors) / sizeof(Color) - 1)];
-			}
-		}
-	}
-
-	inline static void entity_move(float movementSpeed, float deltaTime) {
-		#define TEXTURE_OFFSET 8
-
-		for (uint32_t i = 0; i < entity; i++) {
-			position[i].x += speed[i].x * movementSpeed * deltaTime;
-			position[i].y += speed[i].y * movementSpeed * deltaTime;
-
-			if (((position[i].x + textureWidth / 2 + TEXTURE_OFFSET) > settings.resolutionWidth) || ((position[i].x + textureWidth / 2 - TEXTURE_OFFSET) < 0))
-				speed[i].x *= -1;
-
-			if (((position[i].y + textureHeight / 2 + TEXTURE_OFFSET) > settings.resolutionHeight) || ((position[i].y + textureHeight / 2 - TEXTURE_OFFSET) < 0))
-				speed[i].y *= -1;
-		}
-	}
-
-	inline static void entity_destroy(Entity entityLocal) {
-		entity = entityLocal;
-		color[entityLocal].a = 0;
-	}
-#elif NETDYNAMICS_CLIENT
-	inline static void entity_spawn(Entity entityRemote, Vector2 positionComponent, Vector2 speedComponent, Color colorComponent) {
-		entity = entityRemote;
-		position[entityRemote] = positionComponent;
-		speed[entityRemote] = speedComponent;
-		color[entityRemote] = colorComponent;
-	}
-
-	inline static void entity_move(Vector2* positionComponent, Vector2 destinationComponent, float maxDistanceDelta, float movementSpeed, float deltaTime) {
-		float toVectorX = destinationComponent.x - positionComponent->x;
-		float toVectorY = destinationComponent.y - positionComponent->y;
-		float squareDistance = toVectorX * toVectorX + toVectorY * toVectorY;
-		float step = maxDistanceDelta * movementSpeed * deltaTime;
-
-		if (squareDistance == 0.0f || (step >= 0.0f && squareDistance <= step * step)) {
-			*positionComponent = destinationComponent;
-
-			return;
-		}
-
-		float distance = sqrtf(squareDistance);
-
-		*positionComponent = (Vector2){ positionComponent->x + toVectorX / distance * step, positionComponent->y + toVectorY / distance * step };
-	}
-
-	inline static void entity_update(Entity entityRemote, Vector2 positionComponent, Vector2 speedComponent) {
-		destination[entityRemote] = positionComponent;
-		speed[entityRemote] = speedComponent;
-	}
-
-	inline static void entity_destroy(Entity entityRemote) {
-		entity = entityRemote;
-		color[entityRemote].a = 0;
-	}
-
-	inline static void entity_flush(void) {
-		entity = 0;
-		memset(position, 0, sizeof(Vector2));
-		memset(speed, 0, sizeof(Vector2));
-		memset(color, 0, sizeof(Color));
-		memset(destination, 0, sizeof(Vector2));
-	}
-#endif
-
-#ifdef NETDYNAMICS_SERVER
-	inline static void message_send_to_all(uint8_t transport, uint8_t id, const Entity* entityLocal) {
-		bool reliable = false;
-		binn* data = binn_list();
-
-		binn_list_add_uint8(data, id);
-
-		if (id == NET_MESSAGE_SPAWN) {
-			reliable = true;
-
-			binn_list_add_uint32(data, *entityLocal);
-			binn_list_add_float(data, position[*entityLocal].x);
-			binn_list_add_float(data, position[*entityLocal].y);
-			binn_list_add_float(data, speed[*entityLocal].x);
-			binn_list_add_float(data, speed[*entityLocal].y);
-			binn_list_add_uint8(data, color[*entityLocal].r);
-			binn_list_add_uint8(data, color[*entityLocal].g);
-			binn_list_add_uint8(data, color[*entityLocal].b);
-		} else if (id == NET_MESSAGE_MOVE) {
-			reliable = false;
-
-			binn_list_add_uint32(data, *entityLocal);
-			binn_list_add_float(data, position[*entityLocal].x);
-			binn_list_add_float(data, position[*entityLocal].y);
-			binn_list_add_float(data, speed[*entityLocal].x);
-			binn_list_add_float(data, speed[*entityLocal].y);
-		} else if (id == NET_MESSAGE_DESTROY) {
-			reliable = true;
-
-			binn_list_add_uint32(data, *entityLocal);
-		} else {
-			goto escape;
-		}
-
-		if (settings.redundantBytes > 0)
-			binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
-
-		if (transport == NET_TRANSPORT_HYPERNET) {
-
-		} else if (transport == NET_TRANSPORT_ENET) {
-			ENetPacket* packet = enet_packet_create(binn_ptr(data), binn_size(data), !reliable ? ENET_PACKET_FLAG_NONE : ENET_PACKET_FLAG_RELIABLE);
-
-			enet_host_broadcast(enetHost, 1, packet);
-		}
-
-		escape:
-
-		binn_free(data);
-	}
-#endif
-
-inline static void message_send(uint8_t transport, void* client, uint8_t id, const Entity* entityLocal) {
-	bool reliable = false;
-	binn* data = binn_list();
-
-	binn_list_add_uint8(data, id);
-
-	if (id == NET_MESSAGE_SPAWN) {
-		reliable = true;
-
-		#ifdef NETDYNAMICS_SERVER
-			binn_list_add_uint32(data, *entityLocal);
-			binn_list_add_float(data, position[*entityLocal].x);
-			binn_list_add_float(data, position[*entityLocal].y);
-			binn_list_add_float(data, speed[*entityLocal].x);
-			binn_list_add_float(data, speed[*entityLocal].y);
-			binn_list_add_uint8(data, color[*entityLocal].r);
-			binn_list_add_uint8(data, color[*entityLocal].g);
-			binn_list_add_uint8(data, color[*entityLocal].b);
-		#elif NETDYNAMICS_CLIENT
-			Vector2 mousePosition = RayGetMousePosition();
-
-			binn_list_add_float(data, mousePosition.x);
-			binn_list_add_float(data, mousePosition.y);
-		#endif
-	} else {
-		goto escape;
-	}
-
-	if (settings.redundantBytes > 0)
-		binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
-
-	if (transport == NET_TRANSPORT_HYPERNET) {
-
-	} else if (transport == NET_TRANSPORT_ENET) {
-		ENetPacket* packet = enet_packet_create(binn_ptr(data), binn_size(data), !reliable ? ENET_PACKET_FLAG_NONE : ENET_PACKET_FLAG_RELIABLE);
-
-		enet_peer_send((ENetPeer*)client, 1, packet);
-	}
-
-	escape:
-
-	binn_free(data);
-}
-
-inline static uint8_t message_receive(char* packet) {
-	binn* data = binn_open(packet);
-	uint8_t id = binn_list_uint8(data, 1);
-
-	if (id == NET_MESSAGE_SPAWN) {
-		#ifdef NETDYNAMICS_SERVER
-			entity_spawn((Vector2){ binn_list_float(data, 2), binn_list_float(data, 3) }, NET_MAX_ENTITY_SPAWN);
-		#elif NETDYNAMICS_CLIENT
-			entity_spawn((Entity)binn_list_uint32(data, 2), (Vector2){ binn_list_float(data, 3), binn_list_float(data, 4) }, (Vector2){ binn_list_float(data, 5), binn_list_float(data, 6) }, (Color){ binn_list_uint8(data, 7), binn_list_uint8(data, 8), binn_list_uint8(data, 9), 255 });
-		#endif
-	} else if (id == NET_MESSAGE_MOVE) {
-		#ifdef NETDYNAMICS_CLIENT
-			static uint64_t currentLag;
-			static uint64_t lastLag;
-
-			if (aws_high_res_clock_get_ticks(&currentLag) == AWS_OP_SUCCESS) {
-				if (lastLag > 0) {
-					float lag = ((currentLag - lastLag) / 1000000.0f) / 1000.0f;
-
-					if (lag > worstLag)
-						worstLag = lag;
-				}
-
-				lastLag = currentLag;
-			}
-
-			entity_update((Entity)binn_list_uint32(data, 2), (Vector2){ binn_list_float(data, 3), binn_list_float(data, 4) }, (Vector2){ binn_list_float(data, 5), binn_list_float(data, 6) });
-		#endif
-	} else if (id == NET_MESSAGE_DESTROY) {
-		#ifdef NETDYNAMICS_CLIENT
-			entity_destroy((Entity)binn_list_uint32(data, 2));
-		#endif
-	}
-
-	binn_free(data);
-
-	return id;
-}
-
-inline static float get_frame_time(void) {
-	if (!settings.headlessMode)
-		return RayGetFrameTime();
-
-	static uint64_t currentTime;
-	static uint64_t lastTime;
-	static float deltaTime;
-
-	if (aws_high_res_clock_get_ticks(&currentTime) == AWS_OP_SUCCESS) {
-		if (lastTime > 0)
-			deltaTime = ((currentTime - lastTime) / 1000000.0f) / 1000.0f;
-
-		lastTime = currentTime;
-	}
-
-	return deltaTime;
-}
-
-// Callbacks
-
-static int ini_callback(void* data, const char* section, const char* name, const char* value) {
-	#define FIELD_MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
-	#define PARSE_INTEGER(v) strtoul(v, NULL, 10)
-	#define PARSE_STRING(v) strdup(v)
-
-	Settings* settings = (Settings*)data;
-
-	if (FIELD_MATCH("Display", "HeadlessMode"))
-		settings->headlessMode = (uint8_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Display", "ResolutionWidth"))
-		settings->resolutionWidth = (uint16_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Display", "ResolutionHeight"))
-		settings->resolutionHeight = (uint16_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Renderer", "FramerateLimit"))
-		settings->framerateLimit = (uint8_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Renderer", "VSync"))
-		settings->vsync = (uint8_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Network", "Transport"))
-		settings->transport = (uint8_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Network", "IP"))
-		settings->ip = PARSE_STRING(value);
-	else if (FIELD_MATCH("Network", "Port"))
-		settings->port = (uint16_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Network", "SendRate"))
-		settings->sendRate = (uint8_t)PARSE_INTEGER(value);
-	else if (FIELD_MATCH("Network", "RedundantBytes"))
-		settings->redundantBytes = (uint32_t)PARSE_INTEGER(value);
-	else
-		return 0;
-
-	return 1;
-}
-
-static uint64_t checksum_callback(const ENetBuffer* buffers, int bufferCount) {
-	return enet_crc64(buffers, bufferCount);
-}
-
-int main(void) {
-	// Settings
-
-	if (ini_parse("settings.ini", ini_callback, &settings) < 0)
-		abort();
-
-	// Main
-
-	char* title = NULL;
-
-	#ifdef NETDYNAMICS_SERVER
-		title = "NetDynamics (Server)";
-	#elif NETDYNAMICS_CLIENT
-		title = "NetDynamics (Client)";
-
-		settings.headlessMode = 0;
-	#endif
-
-	if (settings.headlessMode) {
-		static struct aws_allocator allocator;
-
-		aws_common_library_init(&allocator);
-	} else {
-		if (settings.vsync > 0)
-			RaySetConfigFlags(FLAG_VSYNC_HINT);
-
-		RayInitWindow((int)settings.resolutionWidth, (int)settings.resolutionHeight, title);
-		RaySetTargetFPS((int)settings.framerateLimit);
-
-		font = RayLoadFontEx("share_tech.ttf", fontSize, 0, 0);
-
-		RaySetTextureFilter(font.texture, FILTER_POINT);
-	}
-
-	// Serialization
-
-	binn_set_alloc_functions(je_malloc, je_realloc, je_free);
-
-	if (settings.redundantBytes > 0) {
-		if (settings.redundantBytes > sizeof(redundancyBuffer))
-			settings.redundantBytes = (uint32_t)sizeof(redundancyBuffer);
-
-		for (uint32_t i = 0; i < settings.redundantBytes; i++) {
-			redundancyBuffer[i] = i % sizeof(uint8_t);
-		}
-	}
-
-	// Network
-
-	char* name = NULL;
-
-	if (settings.transport == NET_TRANSPORT_HYPERNET) {
-		name = "HyperNet";
-
-
-	} else if (settings.transport == NET_TRANSPORT_ENET) {
-		name = "ENet";
-
-		ENetCallbacks callbacks = {
-			je_malloc,
-			je_free,
-			abort
-		};
-
-		if (enet_initialize_with_callbacks(enet_linked_version(), &callbacks) < 0) {
-			error = "ENet initialization failed";
-		} else {
-			ENetAddress address = { 0 };
-
-			address.port = settings.port;
-
-			#ifdef NETDYNAMICS_SERVER
-				if ((enetHost = enet_host_create(&address, NET_MAX_CLIENTS, NET_MAX_CHANNELS, 0, 0, 1024 * 1024)) == NULL)
-					error = string_host_failed;
-				else
-					status = string_listening;
-			#elif NETDYNAMICS_CLIENT
-				if (enet_address_set_hostname(&address, settings.ip) < 0) {
-					error = string_address_failed;
-				} else {
-					if ((enetHost = enet_host_create(NULL, 1, 0, 0, 0, 1024 * 1024)) == NULL) {
-						error = string_host_failed;
-					} else {
-						if ((enetPeer = enet_host_connect(enetHost, &address, NET_MAX_CHANNELS, 0)) == NULL)
-							error = string_connection_failed;
-						else
-							status = string_connecting;
-					}
-				}
-			#endif
-
-			if (enetHost != NULL) {
-				enet_host_set_checksum_callback(enetHost, checksum_callback);
-			}
-		}
-	} else {
-		error = "Set the correct number of a network transport";
-	}
-
-	free(settings.ip);
-
-	// Data
-
-	if (error == NULL) {
-		position = (Vector2*)je_calloc(NET_MAX_ENTITIES, sizeof(Vector2));
-		speed = (Vector2*)je_calloc(NET_MAX_ENTITIES, sizeof(Vector2));
-		color = (Color*)je_calloc(NET_MAX_ENTITIES, sizeof(Color));
-
-		if (!settings.headlessMode)
-			texture = RayLoadTexture("neon_circle.png");
-
-		#ifdef NETDYNAMICS_CLIENT
-			destination = (Vector2*)je_calloc(NET_MAX_ENTITIES, sizeof(Vector2));
-		#endif
-	}
-
-	#ifdef NETDYNAMICS_SERVER
-		float sendInterval = 1.0f / settings.sendRate;
-	#elif NETDYNAMICS_CLIENT
-		uint32_t rtt = 0;
-	#endif
-
-	while (settings.headlessMode || !RayWindowShouldClose()) {
-		float deltaTime = get_frame_time();
-
-		if (error == NULL) {
-			// Transport
-			if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-			} else if (settings.transport == NET_TRANSPORT_ENET) {
-				static ENetEvent event = { 0 };
-
-				bool polled = false;
-
-				while (!polled) {
-					if (enet_host_check_events(enetHost, &event) <= 0) {
-						if (enet_host_service(enetHost, &event, 0) <= 0)
-							break;
-
-						polled = true;
-					}
-
-					switch (event.type) {
-						case ENET_EVENT_TYPE_NONE:
-							break;
-
-						case ENET_EVENT_TYPE_CONNECT: {
-							#ifdef NETDYNAMICS_SERVER
-								connected = enetHost->connectedPeers;
-
-								if (ENTITIES_EXIST()) {
-									for (uint32_t i = 0; i <= entity; i++) {
-										message_send(NET_TRANSPORT_ENET, event.peer, NET_MESSAGE_SPAWN, &i);
-									}
-								}
-							#elif NETDYNAMICS_CLIENT
-								connected = true;
-								status = string_connected;
-							#endif
-
-							break;
-						}
-
-						case ENET_EVENT_TYPE_DISCONNECT: case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT: {
-							#ifdef NETDYNAMICS_SERVER
-								connected = enetHost->connectedPeers;
-							#elif NETDYNAMICS_CLIENT
-								connected = false;
-								worstLag = 0.0f;
-								status = string_disconnected;
-
-								entity_flush();
-							#endif
-
-							break;
-						}
-
-						case ENET_EVENT_TYPE_RECEIVE: {
-							uint8_t id = message_receive((char*)event.packet->data);
-
-							#ifdef NETDYNAMICS_SERVER
-								if (id == NET_MESSAGE_SPAWN) {
-									for (uint32_t i = entity - NET_MAX_ENTITY_SPAWN; i <= entity; i++) {
-										message_send_to_all(NET_TRANSPORT_ENET, NET_MESSAGE_SPAWN, &i);
-									}
-								}
-							#endif
-
-							enet_packet_destroy(event.packet);
-
-							break;
-						}
-					}
-				}
-
-				#ifdef NETDYNAMICS_CLIENT
-					rtt = enetPeer->roundTripTime;
-				#endif
-			}
-
-			// Timer
-			#ifdef NETDYNAMICS_SERVER
-				static float sendTime = 0.0f;
-
-				sendTime += deltaTime;
-			#endif
-
-			// Spawn
-			if (!settings.headlessMode) {
-				if (RayIsMouseButtonDown(MOUSE_LEFT_BUTTON) || RayIsKeyPressed(KEY_SPACE)) {
-					#ifdef NETDYNAMICS_SERVER
-						entity_spawn(RayGetMousePosition(), NET_MAX_ENTITY_SPAWN);
-
-						if (connected > 0) {
-							if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-							} else if (settings.transport == NET_TRANSPORT_ENET) {
-								enet_host_flush(enetHost);
-
-								for (uint32_t i = entity - NET_MAX_ENTITY_SPAWN; i <= entity; i++) {
-									message_send_to_all(NET_TRANSPORT_ENET, NET_MESSAGE_SPAWN, &i);
-								}
-							}
-						}
-					#elif NETDYNAMICS_CLIENT
-						if (connected) {
-							if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-							} else if (settings.transport == NET_TRANSPORT_ENET) {
-								enet_host_flush(enetHost);
-
-								message_send(NET_TRANSPORT_ENET, enetPeer, NET_MESSAGE_SPAWN, NULL);
-							}
-						}
-					#endif
-				}
-			}
-
-			// Move
-			if (ENTITIES_EXIST()) {
-				#ifdef NETDYNAMICS_SERVER
-					entity_move(NET_MAX_ENTITY_SPEED, deltaTime);
-
-					if (connected > 0) {
-						if (sendTime >= sendInterval) {
-							sendTime -= sendInterval;
-
-							if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-							} else if (settings.transport == NET_TRANSPORT_ENET) {
-								enet_host_flush(enetHost);
-
-								for (uint32_t i = 0; i < entity; i++) {
-									message_send_to_all(NET_TRANSPORT_ENET, NET_MESSAGE_MOVE, &i);
-								}
-							}
-						}
-					}
-				#elif NETDYNAMICS_CLIENT
-					for (uint32_t i = 0; i < entity; i++) {
-						if (destination[i].x == 0.0f && destination[i].y == 0.0f)
-							continue;
-
-						entity_move(&position[i], destination[i], sqrtf(speed[i].x * speed[i].x + speed[i].y * speed[i].y), NET_MAX_ENTITY_SPEED, deltaTime);
-					}
-				#endif
-			}
-
-			// Destroy
-			#ifdef NETDYNAMICS_SERVER
-				if (!settings.headlessMode) {
-					if (ENTITIES_EXIST()) {
-						if (RayIsMouseButtonDown(MOUSE_RIGHT_BUTTON) || RayIsKeyPressed(KEY_BACKSPACE)) {
-							Entity entities = entity - NET_MAX_ENTITY_SPAWN;
-
-							entity_destroy(entities);
-
-							if (connected > 0) {
-								if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-								} else if (settings.transport == NET_TRANSPORT_ENET) {
-									enet_host_flush(enetHost);
-
-									message_send_to_all(NET_TRANSPORT_ENET, NET_MESSAGE_DESTROY, &entities);
-								}
-							}
-						}
-					}
-				}
-			#endif
-		}
-
-		if (!settings.headlessMode) {
-			// Render
-			RayBeginDrawing();
-			RayClearBackground(CLITERAL{ 20, 0, 48, 255 });
-
-			if (error != NULL) {
-				// Error
-				RayDrawTextEx(font, RayFormatText("ERROR %s", error), (Vector2){ 10, 10 }, fontSize, 0, WHITE);
-			} else {
-				// Entities
-				if (ENTITIES_EXIST()) {
-					for (uint32_t i = 0; i < entity; i++) {
-						RayDrawTexture(texture, position[i].x, position[i].y, color[i]);
-					}
-				}
-
-				// Stats
-				static int fps = 0;
-				static int counter = 0;
-				static int refreshRate = 20;
-
-				if (counter < refreshRate) {
-					counter++;
-				} else {
-					fps = RayGetFPS();
-					refreshRate = fps;
-					counter = 0;
-				}
-
-				RayDrawTextEx(font, RayFormatText("FPS %i", fps), (Vector2){ 10, 10 }, fontSize, 0, WHITE);
-				RayDrawTextEx(font, RayFormatText("ENTITIES %i", entity), (Vector2){ 10, 35 }, fontSize, 0, WHITE);
-				RayDrawTextEx(font, name, (Vector2){ 10, 75 }, fontSize, 0, WHITE);
-				RayDrawTextEx(font, RayFormatText("STATUS %s", status), (Vector2){ 10, 100 }, fontSize, 0, WHITE);
-
-				#ifdef NETDYNAMICS_SERVER
-					RayDrawTextEx(font, RayFormatText("CONNECTED CLIENTS %u/%u", connected, NET_MAX_CLIENTS), (Vector2){ 10, 125 }, fontSize, 0, WHITE);
-					RayDrawTextEx(font, RayFormatText("SEND RATE %u", settings.sendRate), (Vector2){ 10, 150 }, fontSize, 0, WHITE);
-					RayDrawTextEx(font, RayFormatText("MESSAGES PER SECOND %u", connected * entity * settings.sendRate), (Vector2){ 10, 175 }, fontSize, 0, WHITE);
-				#elif NETDYNAMICS_CLIENT
-					if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-					} else if (settings.transport == NET_TRANSPORT_ENET) {
-						RayDrawTextEx(font, RayFormatText("RTT %u", rtt), (Vector2){ 10, 125 }, fontSize, 0, WHITE);
-						RayDrawTextEx(font, RayFormatText("Packets sent %u", enetPeer->totalPacketsSent), (Vector2){ 10, 150 }, fontSize, 0, WHITE);
-						RayDrawTextEx(font, RayFormatText("Packets lost %u", enetPeer->totalPacketsLost), (Vector2){ 10, 175 }, fontSize, 0, WHITE);
-						RayDrawTextEx(font, RayFormatText("Packets throttle %.1f%%", enet_peer_get_packets_throttle(enetPeer)), (Vector2){ 10, 200 }, fontSize, 0, WHITE);
-						RayDrawTextEx(font, RayFormatText("Worst lag %.2f ms", worstLag), (Vector2){ 10, 225 }, fontSize, 0, WHITE);
-					}
-				#endif
-			}
-
-			RayEndDrawing();
-		} else {
-			aws_thread_current_sleep((1000 / settings.framerateLimit) * 1000000);
-		}
-	}
-
-	if (settings.transport == NET_TRANSPORT_HYPERNET) {
-
-	} else if (settings.transport == NET_TRANSPORT_ENET) {
-		if (enetHost != NULL) {
-			#ifdef NETDYNAMICS_SERVER
-				for (uint32_t i = 0; i < enetHost->peerCount; i++) {
-					enet_peer_disconnect_now(&enetHost->peers[i], 0);
-				}
-			#elif NETDYNAMICS_CLIENT
-				if (enetPeer != NULL)
-					enet_peer_disconnect_now(enetPeer, 0);
-			#endif
-
-			enet_host_flush(enetHost);
-			enet_host_destroy(enetHost);
-		}
-
-		enet_deinitialize();
-	}
-
-	if (error == NULL) {
-		je_free(position);
-		je_free(speed);
-		je_free(color);
-
-		#ifdef NETDYNAMICS_CLIENT
-			je_free(destination);
-		#endif
-
-		if (!settings.headlessMode)
-			RayUnloadTexture(texture);
-	}
-
-	if (settings.headlessMode)
-		aws_common_library_clean_up();
-	else
-		RayCloseWindow();
-}
+/****************************** Module Header ******************************\
+* Module Name:  netdynamics.c
+* Project:      NetDynamics
+* Copyright (c) 2019 Stanislav Denisov
+*
+* Data-oriented networking playground for the reliable UDP transports
+*
+* This source is subject to the Microsoft Public License.
+* See https://opensource.org/licenses/MS-PL
+* All other rights reserved.
+*
+* THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+* EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+\***************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <limits.h>
+#include "aws/common/clock.h" // https://github.com/awslabs/aws-c-common
+#include "aws/common/thread.h"
+#include "aws/common/atomics.h"
+#include "aws/common/mutex.h"
+#include "aws/common/condition_variable.h"
+#include "jemalloc/jemalloc.h" // https://github.com/jemalloc/jemalloc
+#include "raylib/raylib.h" // https://github.com/raysan5/raylib
+#include "raylib/rlgl.h"
+#include "enet/enet.h" // https://github.com/nxrighthere/ENet-CSharp
+#include "binn/binn.h" // https://github.com/liteserver/binn
+#include "ini/ini.h" // https://github.com/benhoyt/inih
+
+#ifdef NETDYNAMICS_COMPRESSION
+	#include "lz4/lz4.h" // https://github.com/lz4/lz4
+	#include "zstd/zstd.h" // https://github.com/facebook/zstd
+#endif
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOGDI
+	#define NOUSER
+	#define NOMINMAX
+
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#define VERSION_MAJOR 1
+#define VERSION_MINOR 0
+#define VERSION_PATCH 9
+
+#define NET_TRANSPORT_HYPERNET 0
+#define NET_TRANSPORT_ENET 1
+#define NET_TRANSPORT_REPLAY 2
+#define NET_TRANSPORT_NULL 3
+
+#define NET_SERIALIZER_BINN 0
+#define NET_SERIALIZER_PACKED 1
+
+#define NET_COMPRESSION_NONE 0
+#define NET_COMPRESSION_LZ4 1
+#define NET_COMPRESSION_ZSTD 2
+
+#define NET_METRICS_NONE 0
+#define NET_METRICS_CSV 1
+#define NET_METRICS_JSON 2
+
+#define NET_CHANNEL_CONTROL 0
+#define NET_CHANNEL_STATE 1
+#define NET_CHANNEL_BULK 2
+#define NET_CHANNELS 3
+
+#define NET_MAX_CLIENTS 32
+#define NET_MAX_CHANNELS 3
+#define NET_MAX_ENTITIES (1 << ENTITY_INDEX_BITS)
+#define NET_ENTITY_CAPACITY 4096
+#define NET_MAX_ENTITY_SPAWN 10
+#define NET_MAX_ENTITY_SPEED 80.0f
+#define NET_BATCH_PAYLOAD 1200
+#define NET_SNAPSHOT_HISTORY 32
+#define NET_SNAPSHOT_PRECISION 16.0f
+#define NET_QUANTIZATION_SPEED_RANGE (300.0f / 60.0f)
+#define NET_QUANTIZATION_SPEED_BITS 10
+#define NET_QUANTIZATION_MAX_POSITION_BITS 24
+#define NET_QUANTIZATION_MAX_SPEED_BITS 16
+#define NET_THREAD_INBOUND_CAPACITY (1 << 12)
+#define NET_THREAD_OUTBOUND_CAPACITY (1 << 17)
+#define NET_THREAD_SERVICE_TIMEOUT 1
+#define NET_MAX_WORKERS 64
+#define NET_JOBS_PER_WORKER 4
+#define NET_PACKET_POOL_MIN_SHIFT 6
+#define NET_PACKET_POOL_MAX_SHIFT 16
+#define NET_PACKET_POOL_WARM_BYTES (256 * 1024)
+#define NET_ARENA_SIZE (1024 * 1024)
+#define NET_CAPTURE_CHUNK (64 * 1024 * 1024)
+#define NET_REPLAY_BURST 1000000
+#define NET_SIMULATION_WHEEL_SLOTS 1024
+#define NET_SIMULATION_ENTRIES 4096
+#define NET_SIMULATION_REORDER_DELAY 10
+#define NET_SIMULATION_BURST 50
+#define NET_SIMULATION_MAX_QUEUE 1000
+#define NET_INTEREST_CELL_SIZE 128
+#define NET_SCHEDULER_BUDGET 16384
+#define NET_STREAM_CHUNK_SIZE 16384
+#define NET_STREAM_MAX_CHUNK_SIZE 65000
+#define NET_STREAM_CHUNKS 1
+#define NET_COMPRESSION_THRESHOLD 128
+#define NET_COMPRESSION_LEVEL 1
+#define NET_SOCKET_BUFFER_SIZE (1024 * 1024)
+#define NET_SOCKET_DATAGRAM_SIZE 1500
+#define NET_INTERPOLATION_SAMPLES 8
+#define NET_EXTRAPOLATION_LIMIT 250
+#define NET_METRICS_INTERVAL 1000
+#define NET_MAX_LOAD_CLIENTS 256
+#define NET_TIMING_MAX_CATCH_UP 5
+#define NET_BENCHMARK_WARMUP 3
+#define NET_BENCHMARK_REPETITIONS 10
+#define NET_BENCHMARK_SEED 0x5EED
+#define NET_COMPRESSION_BUFFER_SIZE (64 * 1024) // Well above the MTU that bounds a datagram
+#define NET_SCHEDULER_SPEED_WEIGHT 0.25f
+#define NET_SCHEDULER_DISTANCE_WEIGHT (1.0f / 256.0f)
+
+#define NET_MESSAGE_SPAWN 0xA
+#define NET_MESSAGE_MOVE 0xB
+#define NET_MESSAGE_DESTROY 0xC
+#define NET_MESSAGE_MOVE_BATCH 0xD
+#define NET_MESSAGE_MOVE_DELTA 0xE
+#define NET_MESSAGE_ACK 0xF
+#define NET_MESSAGE_MOVE_QUANTIZED 0x10
+#define NET_MESSAGE_VIEW 0x11
+#define NET_MESSAGE_SPAWN_BATCH 0x12
+#define NET_MESSAGE_DESTROY_RANGE 0x13
+
+typedef struct _Settings {
+	uint8_t headlessMode;
+	uint16_t resolutionWidth;
+	uint16_t resolutionHeight;
+	uint8_t framerateLimit;
+	uint8_t vsync;
+	uint8_t meshBatch;
+	uint8_t transport;
+	char* ip;
+	uint16_t port;
+	uint8_t sendRate;
+	uint32_t redundantBytes;
+	uint16_t batchSize;
+	uint32_t maxPayload;
+	uint8_t serializer;
+	uint8_t deltaCompression;
+	uint8_t positionBits;
+	uint8_t speedBits;
+	uint8_t kernel;
+	uint8_t networkThread;
+	uint8_t workers;
+	uint8_t profiler;
+	uint8_t latency;
+	uint8_t arena;
+	uint32_t arenaSize;
+	uint8_t interest;
+	uint16_t cellSize;
+	uint16_t viewX;
+	uint16_t viewY;
+	uint16_t viewWidth;
+	uint16_t viewHeight;
+	uint8_t scheduler;
+	uint32_t budget;
+	uint32_t streamChunkSize;
+	uint8_t streamChunks;
+	uint8_t compression;
+	uint16_t compressionThreshold;
+	uint8_t compressionLevel;
+	uint16_t socketBufferDatagrams;
+	uint8_t metrics;
+	uint32_t metricsInterval;
+	char* metricsFile;
+	uint16_t loadClients;
+	char* scenario;
+	uint16_t tickRate;
+	uint8_t maxCatchUp;
+	char* captureFile;
+	char* replay;
+	uint8_t simulation;
+	float simulationLoss;
+	uint16_t simulationLatency;
+	uint16_t simulationJitter;
+	float simulationDuplication;
+	float simulationReordering;
+	uint32_t simulationBandwidth;
+	uint16_t interpolationDelay;
+	uint16_t extrapolationLimit;
+	uint8_t channels[NET_CHANNELS];
+	uint16_t channelRates[NET_CHANNELS];
+	uint32_t controlPayload;
+	uint16_t benchmarkWarmup;
+	uint16_t benchmarkRepetitions;
+	char* benchmarkFile;
+} Settings;
+
+static uint8_t redundancyBuffer[1024 * 1024];
+
+static const Color colors[] = {
+	{ 250, 250, 250, 255 },
+	{ 255, 0, 90, 255 },
+	{ 94, 8, 255, 255 },
+	{ 0, 80, 255, 255 },
+	{ 0, 220, 255, 255 },
+	{ 255, 255, 14, 255 }
+};
+
+static Settings settings;
+
+static Font font;
+static const int fontSize = 25;
+static const int textureWidth = 32;
+static const int textureHeight = 32;
+
+static const char* status;
+static const char* error;
+
+#ifdef NETDYNAMICS_CLIENT
+	static bool connected;
+	static float worstLag;
+	static uint64_t lastLag;
+	static double interpolationClock;
+	static uint64_t stateTime; // Server send time of the message being received, zero if it has no stamp
+	static double stateClock; // Interpolation clock the state of the message is sampled at
+	static int64_t clockOffset; // Smallest difference between arrival and send time
+	static bool clockSynchronized;
+	static uint32_t loadCurrent;
+#elif NETDYNAMICS_SERVER
+	static uint32_t connected;
+	static uint32_t updates;
+	static void* clients[NET_MAX_CLIENTS];
+#endif
+
+// ENet
+
+static ENetHost* enetHost;
+static ENetPeer* enetPeer;
+
+// Transport
+
+#define TRANSPORT_EVENT_CONNECT 1
+#define TRANSPORT_EVENT_DISCONNECT 2
+#define TRANSPORT_EVENT_RECEIVE 3
+
+typedef struct _TransportEvent {
+	uint8_t type;
+	void* peer;
+	uint32_t peerID;
+	uint8_t* data;
+	size_t length;
+	void* packet;
+	bool reliable;
+} TransportEvent;
+
+typedef struct _TransportStats {
+	uint32_t id;
+	uint32_t rtt;
+	uint32_t packetsSent;
+	uint32_t packetsLost;
+	float throttle;
+	bool connected;
+} TransportStats;
+
+// Backends are chosen once at startup, a null peer on the client addresses the server
+typedef struct _Transport {
+	const char* name;
+	const char* (*initialize)(void);
+	const char* (*connect)(void);
+	bool (*poll)(TransportEvent* event);
+	void (*release)(TransportEvent* event);
+	void (*send)(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable);
+	void (*broadcast)(uint8_t* data, size_t length, uint8_t channel, bool reliable);
+	void (*flush)(void);
+	uint32_t (*identify)(void* peer);
+	uint32_t (*connections)(void);
+	bool (*stats)(void* peer, TransportStats* stats);
+	void (*shutdown)(void);
+} Transport;
+
+static const Transport* transport;
+
+// Strings
+
+static const char* string_listening = "Listening for connections";
+static const char* string_connecting = "Connecting to server...";
+static const char* string_connected = "Connected to server";
+static const char* string_disconnected = "Disconnected from server";
+static const char* string_server_failed = "Server creation failed";
+static const char* string_client_failed = "Client creation failed";
+static const char* string_host_failed = "Host creation failed";
+static const char* string_address_failed = "Address assignment failed";
+static const char* string_listening_failed = "Server listening failed";
+static const char* string_connection_failed = "Connection failed";
+static const char* string_entities_failed = "Entities allocation failed";
+
+// Entities
+
+typedef uint32_t Entity;
+
+// Handles carry a generation above the index, so stale references to a reused slot are rejected
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_GENERATION_MASK 0xFFF
+#define ENTITY_NONE UINT32_MAX
+
+#define ENTITY_INDEX(e) ((e) & ((1u << ENTITY_INDEX_BITS) - 1))
+#define ENTITY_GENERATION(e) ((e) >> ENTITY_INDEX_BITS)
+#define ENTITY_HANDLE(i, g) (((uint32_t)(g) << ENTITY_INDEX_BITS) | (i))
+
+typedef struct _Entities {
+	uint32_t* sparse; // Dense slot of a live index, or the next free index
+	Entity* dense;
+	uint16_t* generation;
+	uint32_t count;
+	uint32_t indices;
+	uint32_t capacity;
+	#ifdef NETDYNAMICS_SERVER
+		uint32_t freeList;
+		uint32_t spawned;
+	#endif
+} Entities;
+
+#ifdef NETDYNAMICS_SERVER
+	static Entities entities = { .freeList = ENTITY_NONE };
+#elif NETDYNAMICS_CLIENT
+	static Entities entities;
+#endif
+
+// Components
+
+#define COMPONENT_ALIGNMENT 64
+#define COMPONENT_FLAGS (MALLOCX_ALIGN(COMPONENT_ALIGNMENT) | MALLOCX_ZERO)
+
+#define COMPONENT_RESERVE(stream, capacity) component_reserve((void**)&(stream), sizeof(*(stream)) * (capacity))
+
+// Streams are indexed by dense slot, so systems iterate live entities only
+typedef struct _Components {
+	float* positionX;
+	float* positionY;
+	float* speedX;
+	float* speedY;
+	float* destinationX;
+	float* destinationY;
+	Color* color;
+	uint32_t* speedChanged;
+	uint32_t* colorChanged;
+	float* priority; // One accumulator per client for each entity
+	double* sampleTime; // Latest server states of each entity, strided by the number of samples
+	float* sampleX;
+	float* sampleY;
+	float* sampleSpeedX;
+	float* sampleSpeedY;
+	uint32_t* samples;
+	uint64_t* stateTime; // Server send time of the latest state
+} Components;
+
+static Components components;
+static Texture2D texture;
+
+inline static bool component_reserve(void** stream, size_t size) {
+	void* pointer = (*stream == NULL) ? je_mallocx(size, COMPONENT_FLAGS) : je_rallocx(*stream, size, COMPONENT_FLAGS);
+
+	if (pointer == NULL)
+		return false;
+
+	*stream = pointer;
+
+	return true;
+}
+
+inline static bool components_reserve(uint32_t capacity) {
+	if (!COMPONENT_RESERVE(components.positionX, capacity) || !COMPONENT_RESERVE(components.positionY, capacity) || !COMPONENT_RESERVE(components.speedX, capacity) || !COMPONENT_RESERVE(components.speedY, capacity) || !COMPONENT_RESERVE(components.color, capacity))
+		return false;
+
+	#ifdef NETDYNAMICS_SERVER
+		if (settings.scheduler > 0 && !COMPONENT_RESERVE(components.priority, capacity * NET_MAX_CLIENTS))
+			return false;
+
+		return COMPONENT_RESERVE(components.speedChanged, capacity) && COMPONENT_RESERVE(components.colorChanged, capacity);
+	#elif NETDYNAMICS_CLIENT
+		if (settings.interpolationDelay > 0) {
+			uint32_t samples = capacity * NET_INTERPOLATION_SAMPLES;
+
+			if (!COMPONENT_RESERVE(components.sampleTime, samples) || !COMPONENT_RESERVE(components.sampleX, samples) || !COMPONENT_RESERVE(components.sampleY, samples) || !COMPONENT_RESERVE(components.sampleSpeedX, samples) || !COMPONENT_RESERVE(components.sampleSpeedY, samples) || !COMPONENT_RESERVE(components.samples, capacity))
+				return false;
+		}
+
+		if (settings.latency > 0 && !COMPONENT_RESERVE(components.stateTime, capacity))
+			return false;
+
+		return COMPONENT_RESERVE(components.destinationX, capacity) && COMPONENT_RESERVE(components.destinationY, capacity);
+	#endif
+}
+
+inline static void components_move(uint32_t target, uint32_t source) {
+	components.positionX[target] = components.positionX[source];
+	components.positionY[target] = components.positionY[source];
+	components.speedX[target] = components.speedX[source];
+	components.speedY[target] = components.speedY[source];
+	components.color[target] = components.color[source];
+
+	#ifdef NETDYNAMICS_SERVER
+		components.speedChanged[target] = components.speedChanged[source];
+		components.colorChanged[target] = components.colorChanged[source];
+
+		if (components.priority != NULL)
+			memcpy(&components.priority[target * NET_MAX_CLIENTS], &components.priority[source * NET_MAX_CLIENTS], sizeof(float) * NET_MAX_CLIENTS);
+	#elif NETDYNAMICS_CLIENT
+		components.destinationX[target] = components.destinationX[source];
+		components.destinationY[target] = components.destinationY[source];
+
+		if (components.samples != NULL) {
+			size_t to = (size_t)target * NET_INTERPOLATION_SAMPLES, from = (size_t)source * NET_INTERPOLATION_SAMPLES;
+
+			memcpy(&components.sampleTime[to], &components.sampleTime[from], sizeof(double) * NET_INTERPOLATION_SAMPLES);
+			memcpy(&components.sampleX[to], &components.sampleX[from], sizeof(float) * NET_INTERPOLATION_SAMPLES);
+			memcpy(&components.sampleY[to], &components.sampleY[from], sizeof(float) * NET_INTERPOLATION_SAMPLES);
+			memcpy(&components.sampleSpeedX[to], &components.sampleSpeedX[from], sizeof(float) * NET_INTERPOLATION_SAMPLES);
+			memcpy(&components.sampleSpeedY[to], &components.sampleSpeedY[from], sizeof(float) * NET_INTERPOLATION_SAMPLES);
+
+			components.samples[target] = components.samples[source];
+		}
+
+		if (components.stateTime != NULL)
+			components.stateTime[target] = components.stateTime[source];
+	#endif
+}
+
+inline static void components_destroy(void) {
+	void* streams[] = { components.positionX, components.positionY, components.speedX, components.speedY, components.destinationX, components.destinationY, components.color, components.speedChanged, components.colorChanged, components.priority, components.sampleTime, components.sampleX, components.sampleY, components.sampleSpeedX, components.sampleSpeedY, components.samples, components.stateTime };
+
+	for (uint32_t i = 0; i < sizeof(streams) / sizeof(void*); i++) {
+		if (streams[i] != NULL)
+			je_dallocx(streams[i], MALLOCX_ALIGN(COMPONENT_ALIGNMENT));
+	}
+
+	memset(&components, 0, sizeof(components));
+}
+
+// Snapshots
+
+static int32_t* snapshotHistory;
+static uint32_t snapshotStride;
+
+#ifdef NETDYNAMICS_SERVER
+	static uint32_t snapshot = 1;
+	static uint32_t acknowledged[NET_MAX_CLIENTS];
+#elif NETDYNAMICS_CLIENT
+	static uint32_t snapshotSequence[NET_SNAPSHOT_HISTORY];
+	static uint32_t snapshotReceived[NET_SNAPSHOT_HISTORY];
+	static uint32_t snapshotTotal[NET_SNAPSHOT_HISTORY];
+	static uint32_t* snapshotChunks; // One bit per entity index of each slot, set at the first index of every chunk received
+#endif
+
+// History is keyed by entity index rather than dense slot, since slots are reshuffled on destroy
+#define SNAPSHOT_SLOT(s) (snapshotHistory + (size_t)((s) % NET_SNAPSHOT_HISTORY) * snapshotStride * 2)
+#define SNAPSHOT_CHUNKS(s) (snapshotChunks + (size_t)((s) % NET_SNAPSHOT_HISTORY) * (snapshotStride / 32))
+
+inline static bool snapshot_reserve(uint32_t indices) {
+	if (snapshotHistory != NULL && indices <= snapshotStride)
+		return true;
+
+	uint32_t stride = NET_ENTITY_CAPACITY;
+
+	while (stride < indices) {
+		stride *= 2;
+	}
+
+	je_free(snapshotHistory);
+
+	snapshotHistory = (int32_t*)je_malloc(sizeof(int32_t) * NET_SNAPSHOT_HISTORY * stride * 2);
+	snapshotStride = (snapshotHistory != NULL) ? stride : 0;
+
+	#ifdef NETDYNAMICS_CLIENT
+		je_free(snapshotChunks);
+
+		snapshotChunks = (uint32_t*)je_calloc(NET_SNAPSHOT_HISTORY * (stride / 32), sizeof(uint32_t));
+
+		if (snapshotChunks == NULL) {
+			je_free(snapshotHistory);
+
+			snapshotHistory = NULL;
+			snapshotStride = 0;
+		}
+	#endif
+
+	// Previous snapshots are gone, so peers start over from an absolute one
+	#ifdef NETDYNAMICS_SERVER
+		memset(acknowledged, 0, sizeof(acknowledged));
+	#elif NETDYNAMICS_CLIENT
+		memset(snapshotSequence, 0, sizeof(snapshotSequence));
+		memset(snapshotReceived, 0, sizeof(snapshotReceived));
+		memset(snapshotTotal, 0, sizeof(snapshotTotal));
+	#endif
+
+	return snapshotHistory != NULL;
+}
+
+// Random
+
+static uint64_t randomState = 0x9E3779B97F4A7C15;
+
+inline static void random_seed(uint64_t seed) {
+	randomState = (seed != 0) ? seed : 0x9E3779B97F4A7C15;
+}
+
+// Xorshift64* is enough for workloads and reproducible across platforms unlike rand()
+inline static uint32_t random_step(uint64_t* state) {
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+
+	return (uint32_t)((*state * 0x2545F4914F6CDD1D) >> 32);
+}
+
+inline static uint32_t random_next(void) {
+	return random_step(&randomState);
+}
+
+inline static int random_range(int minimum, int maximum) {
+	if (minimum > maximum) {
+		int value = minimum;
+
+		minimum = maximum;
+		maximum = value;
+	}
+
+	return minimum + (int)(random_next() % (uint32_t)(maximum - minimum + 1));
+}
+
+// Systems
+
+#define ENTITIES_EXIST() (entities.count > 0)
+
+inline static void entities_destroy(void) {
+	void* streams[] = { entities.sparse, entities.dense, entities.generation };
+
+	for (uint32_t i = 0; i < sizeof(streams) / sizeof(void*); i++) {
+		if (streams[i] != NULL)
+			je_dallocx(streams[i], MALLOCX_ALIGN(COMPONENT_ALIGNMENT));
+	}
+
+	memset(&entities, 0, sizeof(entities));
+
+	components_destroy();
+}
+
+inline static bool entities_reserve(uint32_t indices) {
+	uint32_t capacity = (entities.capacity > 0) ? entities.capacity : NET_ENTITY_CAPACITY;
+
+	while (capacity < indices) {
+		capacity *= 2;
+	}
+
+	if (capacity > NET_MAX_ENTITIES)
+		capacity = NET_MAX_ENTITIES;
+
+	if (capacity < indices)
+		return false;
+
+	if (capacity == entities.capacity)
+		return true;
+
+	if (!COMPONENT_RESERVE(entities.sparse, capacity) || !COMPONENT_RESERVE(entities.dense, capacity) || !COMPONENT_RESERVE(entities.generation, capacity) || !components_reserve(capacity)) {
+		// A failed growth keeps the old streams, a failed first reservation has nothing to keep
+		if (entities.capacity == 0)
+			entities_destroy();
+
+		return false;
+	}
+
+	entities.capacity = capacity;
+
+	return true;
+}
+
+inline static uint32_t entity_lookup(uint32_t index) {
+	if (index >= entities.indices)
+		return ENTITY_NONE;
+
+	uint32_t slot = entities.sparse[index];
+
+	if (slot < entities.count && ENTITY_INDEX(entities.dense[slot]) == index)
+		return slot;
+
+	return ENTITY_NONE;
+}
+
+inline static uint32_t entity_slot(Entity handle) {
+	uint32_t slot = entity_lookup(ENTITY_INDEX(handle));
+
+	if (slot != ENTITY_NONE && entities.dense[slot] == handle)
+		return slot;
+
+	return ENTITY_NONE;
+}
+
+inline static bool entity_remove(Entity handle) {
+	uint32_t slot = entity_slot(handle);
+
+	if (slot == ENTITY_NONE)
+		return false;
+
+	uint32_t last = --entities.count;
+
+	if (slot != last) {
+		Entity moved = entities.dense[last];
+
+		entities.dense[slot] = moved;
+		entities.sparse[ENTITY_INDEX(moved)] = slot;
+
+		components_move(slot, last);
+	}
+
+	#ifdef NETDYNAMICS_SERVER
+		uint32_t index = ENTITY_INDEX(handle);
+
+		entities.generation[index] = (entities.generation[index] + 1) & ENTITY_GENERATION_MASK;
+		entities.sparse[index] = entities.freeList;
+		entities.freeList = index;
+	#endif
+
+	return true;
+}
+
+#ifdef NETDYNAMICS_SERVER
+	inline static uint32_t entity_create(void) {
+		uint32_t index;
+
+		if (entities.freeList != ENTITY_NONE) {
+			index = entities.freeList;
+			entities.freeList = entities.sparse[index];
+		} else {
+			if (entities.indices == entities.capacity && !entities_reserve(entities.indices + 1))
+				return ENTITY_NONE;
+
+			index = entities.indices++;
+		}
+
+		uint32_t slot = entities.count++;
+
+		entities.sparse[index] = slot;
+		entities.dense[slot] = ENTITY_HANDLE(index, entities.generation[index]);
+
+		return slot;
+	}
+
+	inline static void entity_spawn(Vector2 positionComponent, uint32_t quantity) {
+		entities.spawned = 0;
+
+		for (uint32_t i = 0; i < quantity; i++) {
+			uint32_t slot = entity_create();
+
+			if (slot == ENTITY_NONE)
+				break;
+
+			components.positionX[slot] = positionComponent.x;
+			components.positionY[slot] = positionComponent.y;
+			components.speedX[slot] = (float)random_range(-300, 300) / 60.0f;
+			components.speedY[slot] = (float)random_range(-300, 300) / 60.0f;
+			components.color[slot] = colors[random_range(0, sizeof(colors) / sizeof(Color) - 1)];
+			components.speedChanged[slot] = snapshot;
+			components.colorChanged[slot] = snapshot;
+
+			if (components.priority != NULL)
+				memset(&components.priority[slot * NET_MAX_CLIENTS], 0, sizeof(float) * NET_MAX_CLIENTS);
+
+			entities.spawned++;
+		}
+	}
+
+	inline static void entity_destroy(Entity entityLocal) {
+		entity_remove(entityLocal);
+	}
+#elif NETDYNAMICS_CLIENT
+	// Samples are stamped with the server send time on the local clock, updates that aren't newer replace the latest sample so the times stay ordered
+	inline static void entity_sample(uint32_t slot, Vector2 positionComponent, Vector2 speedComponent) {
+		if (components.samples == NULL)
+			return;
+
+		uint32_t count = components.samples[slot];
+		size_t base = (size_t)slot * NET_INTERPOLATION_SAMPLES;
+		double time = stateClock;
+
+		if (count == 0 || components.sampleTime[base + (count - 1) % NET_INTERPOLATION_SAMPLES] < time)
+			count = ++components.samples[slot];
+		else
+			time = components.sampleTime[base + (count - 1) % NET_INTERPOLATION_SAMPLES];
+
+		size_t sample = base + (count - 1) % NET_INTERPOLATION_SAMPLES;
+
+		components.sampleTime[sample] = time;
+		components.sampleX[sample] = positionComponent.x;
+		components.sampleY[sample] = positionComponent.y;
+		components.sampleSpeedX[sample] = speedComponent.x;
+		components.sampleSpeedY[sample] = speedComponent.y;
+	}
+
+	inline static void entity_spawn(Entity entityRemote, Vector2 positionComponent, Vector2 speedComponent, Color colorComponent) {
+		uint32_t index = ENTITY_INDEX(entityRemote);
+		uint32_t slot = entity_lookup(index);
+
+		// The join stream and live spawns travel on different channels, so a stale spawn may arrive after the index was reused
+		if (slot != ENTITY_NONE) {
+			uint32_t age = (ENTITY_GENERATION(entities.dense[slot]) - ENTITY_GENERATION(entityRemote)) & ENTITY_GENERATION_MASK;
+
+			if (age != 0 && age <= ENTITY_GENERATION_MASK / 2)
+				return;
+		}
+
+		if (slot == ENTITY_NONE) {
+			if (index >= entities.capacity && !entities_reserve(index + 1))
+				return;
+
+			if (index >= entities.indices)
+				entities.indices = index + 1;
+
+			slot = entities.count++;
+			entities.sparse[index] = slot;
+		}
+
+		entities.dense[slot] = entityRemote;
+		components.positionX[slot] = positionComponent.x;
+		components.positionY[slot] = positionComponent.y;
+		components.speedX[slot] = speedComponent.x;
+		components.speedY[slot] = speedComponent.y;
+		components.destinationX[slot] = 0.0f;
+		components.destinationY[slot] = 0.0f;
+		components.color[slot] = colorComponent;
+
+		if (components.samples != NULL)
+			components.samples[slot] = 0;
+
+		if (components.stateTime != NULL)
+			components.stateTime[slot] = 0;
+
+		entity_sample(slot, positionComponent, speedComponent);
+	}
+
+	inline static void entity_move(uint32_t slot, float maxDistanceDelta, float movementSpeed, float deltaTime) {
+		float toVectorX = components.destinationX[slot] - components.positionX[slot];
+		float toVectorY = components.destinationY[slot] - components.positionY[slot];
+		float squareDistance = toVectorX * toVectorX + toVectorY * toVectorY;
+		float step = maxDistanceDelta * movementSpeed * deltaTime;
+
+		if (squareDistance == 0.0f || (step >= 0.0f && squareDistance <= step * step)) {
+			components.positionX[slot] = components.destinationX[slot];
+			components.positionY[slot] = components.destinationY[slot];
+
+			return;
+		}
+
+		float distance = sqrtf(squareDistance);
+
+		components.positionX[slot] += toVectorX / distance * step;
+		components.positionY[slot] += toVectorY / distance * step;
+	}
+
+	inline static void entity_update(uint32_t slot, Vector2 positionComponent, Vector2 speedComponent) {
+		if (slot == ENTITY_NONE)
+			return;
+
+		components.destinationX[slot] = positionComponent.x;
+		components.destinationY[slot] = positionComponent.y;
+		components.speedX[slot] = speedComponent.x;
+		components.speedY[slot] = speedComponent.y;
+
+		if (components.stateTime != NULL)
+			components.stateTime[slot] = stateTime;
+
+		entity_sample(slot, positionComponent, speedComponent);
+	}
+
+	// Renders the world behind the clock by the interpolation delay, late entities are dead reckoned from their latest speed for a limited time
+	inline static void entity_interpolate(uint32_t first, uint32_t last, float movementSpeed) {
+		double renderTime = interpolationClock - settings.interpolationDelay / 1000.0;
+		double extrapolationLimit = settings.extrapolationLimit / 1000.0;
+
+		for (uint32_t i = first; i < last; i++) {
+			uint32_t count = components.samples[i];
+
+			if (count == 0)
+				continue;
+
+			size_t base = (size_t)i * NET_INTERPOLATION_SAMPLES;
+			uint32_t available = (count < NET_INTERPOLATION_SAMPLES) ? count : NET_INTERPOLATION_SAMPLES;
+			size_t newer = base + (count - 1) % NET_INTERPOLATION_SAMPLES;
+
+			if (renderTime >= components.sampleTime[newer]) {
+				double elapsed = renderTime - components.sampleTime[newer];
+
+				if (elapsed > extrapolationLimit)
+					elapsed = extrapolationLimit;
+
+				components.positionX[i] = components.sampleX[newer] + components.sampleSpeedX[newer] * movementSpeed * (float)elapsed;
+				components.positionY[i] = components.sampleY[newer] + components.sampleSpeedY[newer] * movementSpeed * (float)elapsed;
+
+				continue;
+			}
+
+			size_t older = newer;
+
+			for (uint32_t j = 2; j <= available; j++) {
+				older = base + (count - j) % NET_INTERPOLATION_SAMPLES;
+
+				if (components.sampleTime[older] <= renderTime)
+					break;
+
+				newer = older;
+			}
+
+			if (older == newer || components.sampleTime[older] > renderTime) {
+				components.positionX[i] = components.sampleX[newer];
+				components.positionY[i] = components.sampleY[newer];
+
+				continue;
+			}
+
+			float factor = (float)((renderTime - components.sampleTime[older]) / (components.sampleTime[newer] - components.sampleTime[older]));
+
+			components.positionX[i] = components.sampleX[older] + (components.sampleX[newer] - components.sampleX[older]) * factor;
+			components.positionY[i] = components.sampleY[older] + (components.sampleY[newer] - components.sampleY[older]) * factor;
+		}
+	}
+
+	inline static void entity_destroy(Entity entityRemote) {
+		entity_remove(entityRemote);
+	}
+
+	// Handles of a range share the generation, so the range can't run past the index space
+	inline static void entity_destroy_range(Entity first, uint32_t count) {
+		uint32_t available = (1u << ENTITY_INDEX_BITS) - ENTITY_INDEX(first);
+
+		if (count > available)
+			count = available;
+
+		for (uint32_t i = 0; i < count; i++) {
+			entity_remove(first + i);
+		}
+	}
+
+	inline static void entity_flush(void) {
+		entities.count = 0;
+		entities.indices = 0;
+		memset(snapshotSequence, 0, sizeof(snapshotSequence));
+		memset(snapshotReceived, 0, sizeof(snapshotReceived));
+		memset(snapshotTotal, 0, sizeof(snapshotTotal));
+	}
+#endif
+
+// Vectorization
+
+// SSE2 is only part of the baseline on x86-64, 32-bit builds stay on the scalar kernel
+#if defined(__x86_64__) || defined(_M_X64)
+	#define SIMD_X86
+
+	#include <immintrin.h>
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+
+		#define SIMD_TARGET_AVX2
+	#else
+		#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define SIMD_NEON
+
+	#include <arm_neon.h>
+#endif
+
+#define SIMD_KERNEL_AUTO 0
+#define SIMD_KERNEL_SCALAR 1
+#define SIMD_KERNEL_SSE 2
+#define SIMD_KERNEL_AVX2 3
+#define SIMD_KERNEL_NEON 4
+
+typedef void (*MoveKernel)(Entity first, Entity last, float movementSpeed, float deltaTime);
+
+static MoveKernel moveKernel;
+
+inline static uint32_t simd_lowest_bit(uint32_t mask) {
+	#ifdef _MSC_VER
+		unsigned long index;
+
+		_BitScanForward(&index, mask);
+
+		return (uint32_t)index;
+	#else
+		return (uint32_t)__builtin_ctz(mask);
+	#endif
+}
+
+#ifdef NETDYNAMICS_SERVER
+	#define TEXTURE_OFFSET 8
+
+	inline static void entity_move_scalar(Entity first, Entity last, float movementSpeed, float deltaTime) {
+		for (uint32_t i = first; i < last; i++) {
+			components.positionX[i] += components.speedX[i] * movementSpeed * deltaTime;
+			components.positionY[i] += components.speedY[i] * movementSpeed * deltaTime;
+
+			if (((components.positionX[i] + textureWidth / 2 + TEXTURE_OFFSET) > settings.resolutionWidth) || ((components.positionX[i] + textureWidth / 2 - TEXTURE_OFFSET) < 0)) {
+				components.speedX[i] *= -1;
+				components.speedChanged[i] = snapshot;
+			}
+
+			if (((components.positionY[i] + textureHeight / 2 + TEXTURE_OFFSET) > settings.resolutionHeight) || ((components.positionY[i] + textureHeight / 2 - TEXTURE_OFFSET) < 0)) {
+				components.speedY[i] *= -1;
+				components.speedChanged[i] = snapshot;
+			}
+		}
+	}
+
+	#ifdef SIMD_X86
+		static void entity_move_sse(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const __m128 scale = _mm_set1_ps(movementSpeed * deltaTime);
+			const __m128 upperX = _mm_set1_ps((float)(settings.resolutionWidth - textureWidth / 2 - TEXTURE_OFFSET));
+			const __m128 upperY = _mm_set1_ps((float)(settings.resolutionHeight - textureHeight / 2 - TEXTURE_OFFSET));
+			const __m128 lowerX = _mm_set1_ps((float)(TEXTURE_OFFSET - textureWidth / 2));
+			const __m128 lowerY = _mm_set1_ps((float)(TEXTURE_OFFSET - textureHeight / 2));
+			const __m128 sign = _mm_set1_ps(-0.0f);
+
+			Entity i = first;
+
+			for (; i < last && (i & 3) != 0; i++) {
+				entity_move_scalar(i, i + 1, movementSpeed, deltaTime);
+			}
+
+			for (; i + 4 <= last; i += 4) {
+				__m128 positionX = _mm_add_ps(_mm_load_ps(&components.positionX[i]), _mm_mul_ps(_mm_load_ps(&components.speedX[i]), scale));
+				__m128 positionY = _mm_add_ps(_mm_load_ps(&components.positionY[i]), _mm_mul_ps(_mm_load_ps(&components.speedY[i]), scale));
+				__m128 bounceX = _mm_or_ps(_mm_cmpgt_ps(positionX, upperX), _mm_cmplt_ps(positionX, lowerX));
+				__m128 bounceY = _mm_or_ps(_mm_cmpgt_ps(positionY, upperY), _mm_cmplt_ps(positionY, lowerY));
+
+				_mm_store_ps(&components.positionX[i], positionX);
+				_mm_store_ps(&components.positionY[i], positionY);
+				_mm_store_ps(&components.speedX[i], _mm_xor_ps(_mm_load_ps(&components.speedX[i]), _mm_and_ps(bounceX, sign)));
+				_mm_store_ps(&components.speedY[i], _mm_xor_ps(_mm_load_ps(&components.speedY[i]), _mm_and_ps(bounceY, sign)));
+
+				int flipped = _mm_movemask_ps(_mm_or_ps(bounceX, bounceY));
+
+				while (flipped != 0) {
+					components.speedChanged[i + simd_lowest_bit(flipped)] = snapshot;
+					flipped &= flipped - 1;
+				}
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+
+		SIMD_TARGET_AVX2 static void entity_move_avx2(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const __m256 scale = _mm256_set1_ps(movementSpeed * deltaTime);
+			const __m256 upperX = _mm256_set1_ps((float)(settings.resolutionWidth - textureWidth / 2 - TEXTURE_OFFSET));
+			const __m256 upperY = _mm256_set1_ps((float)(settings.resolutionHeight - textureHeight / 2 - TEXTURE_OFFSET));
+			const __m256 lowerX = _mm256_set1_ps((float)(TEXTURE_OFFSET - textureWidth / 2));
+			const __m256 lowerY = _mm256_set1_ps((float)(TEXTURE_OFFSET - textureHeight / 2));
+			const __m256 sign = _mm256_set1_ps(-0.0f);
+
+			Entity i = first;
+
+			for (; i < last && (i & 7) != 0; i++) {
+				entity_move_scalar(i, i + 1, movementSpeed, deltaTime);
+			}
+
+			for (; i + 8 <= last; i += 8) {
+				__m256 positionX = _mm256_add_ps(_mm256_load_ps(&components.positionX[i]), _mm256_mul_ps(_mm256_load_ps(&components.speedX[i]), scale));
+				__m256 positionY = _mm256_add_ps(_mm256_load_ps(&components.positionY[i]), _mm256_mul_ps(_mm256_load_ps(&components.speedY[i]), scale));
+				__m256 bounceX = _mm256_or_ps(_mm256_cmp_ps(positionX, upperX, _CMP_GT_OQ), _mm256_cmp_ps(positionX, lowerX, _CMP_LT_OQ));
+				__m256 bounceY = _mm256_or_ps(_mm256_cmp_ps(positionY, upperY, _CMP_GT_OQ), _mm256_cmp_ps(positionY, lowerY, _CMP_LT_OQ));
+
+				_mm256_store_ps(&components.positionX[i], positionX);
+				_mm256_store_ps(&components.positionY[i], positionY);
+				_mm256_store_ps(&components.speedX[i], _mm256_xor_ps(_mm256_load_ps(&components.speedX[i]), _mm256_and_ps(bounceX, sign)));
+				_mm256_store_ps(&components.speedY[i], _mm256_xor_ps(_mm256_load_ps(&components.speedY[i]), _mm256_and_ps(bounceY, sign)));
+
+				int flipped = _mm256_movemask_ps(_mm256_or_ps(bounceX, bounceY));
+
+				while (flipped != 0) {
+					components.speedChanged[i + simd_lowest_bit(flipped)] = snapshot;
+					flipped &= flipped - 1;
+				}
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+	#elif defined(SIMD_NEON)
+		static void entity_move_neon(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const float32x4_t scale = vdupq_n_f32(movementSpeed * deltaTime);
+			const float32x4_t upperX = vdupq_n_f32((float)(settings.resolutionWidth - textureWidth / 2 - TEXTURE_OFFSET));
+			const float32x4_t upperY = vdupq_n_f32((float)(settings.resolutionHeight - textureHeight / 2 - TEXTURE_OFFSET));
+			const float32x4_t lowerX = vdupq_n_f32((float)(TEXTURE_OFFSET - textureWidth / 2));
+			const float32x4_t lowerY = vdupq_n_f32((float)(TEXTURE_OFFSET - textureHeight / 2));
+			const uint32x4_t sign = vdupq_n_u32(0x80000000);
+
+			Entity i = first;
+
+			for (; i + 4 <= last; i += 4) {
+				float32x4_t speedX = vld1q_f32(&components.speedX[i]);
+				float32x4_t speedY = vld1q_f32(&components.speedY[i]);
+				float32x4_t positionX = vmlaq_f32(vld1q_f32(&components.positionX[i]), speedX, scale);
+				float32x4_t positionY = vmlaq_f32(vld1q_f32(&components.positionY[i]), speedY, scale);
+				uint32x4_t bounceX = vorrq_u32(vcgtq_f32(positionX, upperX), vcltq_f32(positionX, lowerX));
+				uint32x4_t bounceY = vorrq_u32(vcgtq_f32(positionY, upperY), vcltq_f32(positionY, lowerY));
+
+				vst1q_f32(&components.positionX[i], positionX);
+				vst1q_f32(&components.positionY[i], positionY);
+				vst1q_f32(&components.speedX[i], vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(speedX), vandq_u32(bounceX, sign))));
+				vst1q_f32(&components.speedY[i], vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(speedY), vandq_u32(bounceY, sign))));
+
+				uint32x4_t bounce = vorrq_u32(bounceX, bounceY);
+
+				if (vmaxvq_u32(bounce) != 0) {
+					uint32_t flipped[4];
+
+					vst1q_u32(flipped, bounce);
+
+					for (uint32_t j = 0; j < 4; j++) {
+						if (flipped[j] != 0)
+							components.speedChanged[i + j] = snapshot;
+					}
+				}
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+	#endif
+#elif NETDYNAMICS_CLIENT
+	inline static void entity_move_scalar(Entity first, Entity last, float movementSpeed, float deltaTime) {
+		for (uint32_t i = first; i < last; i++) {
+			if (components.destinationX[i] == 0.0f && components.destinationY[i] == 0.0f)
+				continue;
+
+			entity_move(i, sqrtf(components.speedX[i] * components.speedX[i] + components.speedY[i] * components.speedY[i]), movementSpeed, deltaTime);
+		}
+	}
+
+	#ifdef SIMD_X86
+		static void entity_move_sse(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const __m128 scale = _mm_set1_ps(movementSpeed * deltaTime);
+			const __m128 zero = _mm_setzero_ps();
+
+			Entity i = first;
+
+			for (; i < last && (i & 3) != 0; i++) {
+				entity_move_scalar(i, i + 1, movementSpeed, deltaTime);
+			}
+
+			for (; i + 4 <= last; i += 4) {
+				__m128 positionX = _mm_load_ps(&components.positionX[i]), positionY = _mm_load_ps(&components.positionY[i]);
+				__m128 destinationX = _mm_load_ps(&components.destinationX[i]), destinationY = _mm_load_ps(&components.destinationY[i]);
+				__m128 speedX = _mm_load_ps(&components.speedX[i]), speedY = _mm_load_ps(&components.speedY[i]);
+
+				__m128 toVectorX = _mm_sub_ps(destinationX, positionX);
+				__m128 toVectorY = _mm_sub_ps(destinationY, positionY);
+				__m128 squareDistance = _mm_add_ps(_mm_mul_ps(toVectorX, toVectorX), _mm_mul_ps(toVectorY, toVectorY));
+				__m128 step = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(speedX, speedX), _mm_mul_ps(speedY, speedY))), scale);
+				__m128 factor = _mm_div_ps(step, _mm_sqrt_ps(squareDistance));
+
+				__m128 snap = _mm_or_ps(_mm_cmpeq_ps(squareDistance, zero), _mm_and_ps(_mm_cmpge_ps(step, zero), _mm_cmple_ps(squareDistance, _mm_mul_ps(step, step))));
+				__m128 skip = _mm_and_ps(_mm_cmpeq_ps(destinationX, zero), _mm_cmpeq_ps(destinationY, zero));
+
+				__m128 resultX = _mm_add_ps(positionX, _mm_mul_ps(toVectorX, factor));
+				__m128 resultY = _mm_add_ps(positionY, _mm_mul_ps(toVectorY, factor));
+
+				resultX = _mm_or_ps(_mm_and_ps(snap, destinationX), _mm_andnot_ps(snap, resultX));
+				resultY = _mm_or_ps(_mm_and_ps(snap, destinationY), _mm_andnot_ps(snap, resultY));
+				resultX = _mm_or_ps(_mm_and_ps(skip, positionX), _mm_andnot_ps(skip, resultX));
+				resultY = _mm_or_ps(_mm_and_ps(skip, positionY), _mm_andnot_ps(skip, resultY));
+
+				_mm_store_ps(&components.positionX[i], resultX);
+				_mm_store_ps(&components.positionY[i], resultY);
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+
+		SIMD_TARGET_AVX2 static void entity_move_avx2(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const __m256 scale = _mm256_set1_ps(movementSpeed * deltaTime);
+			const __m256 zero = _mm256_setzero_ps();
+
+			Entity i = first;
+
+			for (; i < last && (i & 7) != 0; i++) {
+				entity_move_scalar(i, i + 1, movementSpeed, deltaTime);
+			}
+
+			for (; i + 8 <= last; i += 8) {
+				__m256 positionX = _mm256_load_ps(&components.positionX[i]), positionY = _mm256_load_ps(&components.positionY[i]);
+				__m256 destinationX = _mm256_load_ps(&components.destinationX[i]), destinationY = _mm256_load_ps(&components.destinationY[i]);
+				__m256 speedX = _mm256_load_ps(&components.speedX[i]), speedY = _mm256_load_ps(&components.speedY[i]);
+
+				__m256 toVectorX = _mm256_sub_ps(destinationX, positionX);
+				__m256 toVectorY = _mm256_sub_ps(destinationY, positionY);
+				__m256 squareDistance = _mm256_add_ps(_mm256_mul_ps(toVectorX, toVectorX), _mm256_mul_ps(toVectorY, toVectorY));
+				__m256 step = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(speedX, speedX), _mm256_mul_ps(speedY, speedY))), scale);
+				__m256 factor = _mm256_div_ps(step, _mm256_sqrt_ps(squareDistance));
+
+				__m256 snap = _mm256_or_ps(_mm256_cmp_ps(squareDistance, zero, _CMP_EQ_OQ), _mm256_and_ps(_mm256_cmp_ps(step, zero, _CMP_GE_OQ), _mm256_cmp_ps(squareDistance, _mm256_mul_ps(step, step), _CMP_LE_OQ)));
+				__m256 skip = _mm256_and_ps(_mm256_cmp_ps(destinationX, zero, _CMP_EQ_OQ), _mm256_cmp_ps(destinationY, zero, _CMP_EQ_OQ));
+
+				__m256 resultX = _mm256_blendv_ps(_mm256_add_ps(positionX, _mm256_mul_ps(toVectorX, factor)), destinationX, snap);
+				__m256 resultY = _mm256_blendv_ps(_mm256_add_ps(positionY, _mm256_mul_ps(toVectorY, factor)), destinationY, snap);
+
+				_mm256_store_ps(&components.positionX[i], _mm256_blendv_ps(resultX, positionX, skip));
+				_mm256_store_ps(&components.positionY[i], _mm256_blendv_ps(resultY, positionY, skip));
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+	#elif defined(SIMD_NEON)
+		static void entity_move_neon(Entity first, Entity last, float movementSpeed, float deltaTime) {
+			const float32x4_t scale = vdupq_n_f32(movementSpeed * deltaTime);
+			const float32x4_t zero = vdupq_n_f32(0.0f);
+
+			Entity i = first;
+
+			for (; i + 4 <= last; i += 4) {
+				float32x4_t positionX = vld1q_f32(&components.positionX[i]), positionY = vld1q_f32(&components.positionY[i]);
+				float32x4_t destinationX = vld1q_f32(&components.destinationX[i]), destinationY = vld1q_f32(&components.destinationY[i]);
+				float32x4_t speedX = vld1q_f32(&components.speedX[i]), speedY = vld1q_f32(&components.speedY[i]);
+
+				float32x4_t toVectorX = vsubq_f32(destinationX, positionX);
+				float32x4_t toVectorY = vsubq_f32(destinationY, positionY);
+				float32x4_t squareDistance = vmlaq_f32(vmulq_f32(toVectorX, toVectorX), toVectorY, toVectorY);
+				float32x4_t step = vmulq_f32(vsqrtq_f32(vmlaq_f32(vmulq_f32(speedX, speedX), speedY, speedY)), scale);
+				float32x4_t factor = vdivq_f32(step, vsqrtq_f32(squareDistance));
+
+				uint32x4_t snap = vorrq_u32(vceqq_f32(squareDistance, zero), vandq_u32(vcgeq_f32(step, zero), vcleq_f32(squareDistance, vmulq_f32(step, step))));
+				uint32x4_t skip = vandq_u32(vceqq_f32(destinationX, zero), vceqq_f32(destinationY, zero));
+
+				vst1q_f32(&components.positionX[i], vbslq_f32(skip, positionX, vbslq_f32(snap, destinationX, vmlaq_f32(positionX, toVectorX, factor))));
+				vst1q_f32(&components.positionY[i], vbslq_f32(skip, positionY, vbslq_f32(snap, destinationY, vmlaq_f32(positionY, toVectorY, factor))));
+			}
+
+			entity_move_scalar(i, last, movementSpeed, deltaTime);
+		}
+	#endif
+#endif
+
+inline static bool simd_avx2_supported(void) {
+	#ifdef SIMD_X86
+		#ifdef _MSC_VER
+			int info[4];
+
+			__cpuid(info, 1);
+
+			// AVX and OSXSAVE, then the operating system must preserve the YMM state
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+
+			return (info[1] & (1 << 5)) != 0;
+		#else
+			return __builtin_cpu_supports("avx2");
+		#endif
+	#else
+		return false;
+	#endif
+}
+
+inline static void simd_initialize(uint8_t kernel) {
+	moveKernel = entity_move_scalar;
+
+	#ifdef SIMD_X86
+		if (kernel == SIMD_KERNEL_SCALAR)
+			return;
+
+		if ((kernel == SIMD_KERNEL_AUTO || kernel == SIMD_KERNEL_AVX2) && simd_avx2_supported()) {
+			moveKernel = entity_move_avx2;
+		} else {
+			moveKernel = entity_move_sse;
+		}
+	#elif defined(SIMD_NEON)
+		if (kernel != SIMD_KERNEL_SCALAR) {
+			moveKernel = entity_move_neon;
+		}
+	#endif
+}
+
+// Arena
+
+#ifdef _MSC_VER
+	#define ARENA_THREAD_LOCAL __declspec(thread)
+#else
+	#define ARENA_THREAD_LOCAL __thread
+#endif
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_HEAP 0
+
+typedef struct _ArenaHeader {
+	uint64_t size;
+	uint64_t owner; // Also keeps the memory behind the header aligned
+} ArenaHeader;
+
+typedef struct _Arena {
+	uint8_t* buffer;
+	size_t capacity;
+	size_t offset;
+	size_t last;
+	size_t peak;
+	uint32_t overflows;
+} Arena;
+
+static Arena arenas[NET_MAX_WORKERS + 1];
+static uint32_t arenaCount;
+static ARENA_THREAD_LOCAL Arena* arenaCurrent;
+
+#define ARENA_HEADER(memory) ((ArenaHeader*)(memory) - 1)
+
+inline static bool arena_create(uint32_t count) {
+	if (settings.arenaSize == 0)
+		settings.arenaSize = NET_ARENA_SIZE;
+
+	for (arenaCount = 0; arenaCount < count; arenaCount++) {
+		if ((arenas[arenaCount].buffer = (uint8_t*)je_mallocx(settings.arenaSize, MALLOCX_ALIGN(ARENA_ALIGNMENT))) == NULL)
+			return false;
+
+		arenas[arenaCount].capacity = settings.arenaSize;
+	}
+
+	arenaCurrent = &arenas[0];
+
+	return true;
+}
+
+inline static void arena_destroy(void) {
+	for (uint32_t i = 0; i < arenaCount; i++) {
+		je_free(arenas[i].buffer);
+	}
+
+	memset(arenas, 0, sizeof(arenas));
+
+	arenaCount = 0;
+	arenaCurrent = NULL;
+}
+
+// Everything allocated from the arenas is dead by the start of a frame, workers are idle at that point
+inline static void arena_reset(void) {
+	for (uint32_t i = 0; i < arenaCount; i++) {
+		arenas[i].offset = 0;
+		arenas[i].last = 0;
+	}
+}
+
+// Threads without an arena and allocations that don't fit fall back to jemalloc
+static void* arena_malloc(size_t size) {
+	Arena* arena = arenaCurrent;
+	size_t total = sizeof(ArenaHeader) + ((size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1));
+	ArenaHeader* header = NULL;
+
+	if (arena != NULL && arena->buffer != NULL && arena->offset + total <= arena->capacity) {
+		header = (ArenaHeader*)(arena->buffer + arena->offset);
+		header->owner = (uint64_t)(arena - arenas) + 1;
+
+		arena->last = arena->offset;
+		arena->offset += total;
+
+		if (arena->peak < arena->offset)
+			arena->peak = arena->offset;
+	} else {
+		if ((header = (ArenaHeader*)je_malloc(sizeof(ArenaHeader) + size)) == NULL)
+			return NULL;
+
+		header->owner = ARENA_HEAP;
+
+		if (arena != NULL)
+			arena->overflows++;
+	}
+
+	header->size = size;
+
+	return header + 1;
+}
+
+// Only the latest allocation of the calling thread is given back, the rest waits for the reset
+static void arena_free(void* memory) {
+	if (memory == NULL)
+		return;
+
+	ArenaHeader* header = ARENA_HEADER(memory);
+
+	if (header->owner == ARENA_HEAP) {
+		je_free(header);
+
+		return;
+	}
+
+	Arena* arena = &arenas[header->owner - 1];
+
+	if (arena == arenaCurrent && (uint8_t*)header == arena->buffer + arena->last)
+		arena->offset = arena->last;
+}
+
+// Growing buffers are usually the latest allocation, so they are extended in place
+static void* arena_realloc(void* memory, size_t size) {
+	if (memory == NULL)
+		return arena_malloc(size);
+
+	ArenaHeader* header = ARENA_HEADER(memory);
+
+	if (header->owner == ARENA_HEAP) {
+		if ((header = (ArenaHeader*)je_realloc(header, sizeof(ArenaHeader) + size)) == NULL)
+			return NULL;
+
+		header->size = size;
+
+		return header + 1;
+	}
+
+	Arena* arena = &arenas[header->owner - 1];
+	size_t total = sizeof(ArenaHeader) + ((size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1));
+
+	if (arena == arenaCurrent && (uint8_t*)header == arena->buffer + arena->last && arena->last + total <= arena->capacity) {
+		header->size = size;
+		arena->offset = arena->last + total;
+
+		if (arena->peak < arena->offset)
+			arena->peak = arena->offset;
+
+		return memory;
+	}
+
+	void* reallocated = arena_malloc(size);
+
+	if (reallocated != NULL) {
+		memcpy(reallocated, memory, (header->size < size) ? header->size : size);
+		arena_free(memory);
+	}
+
+	return reallocated;
+}
+
+// Peaks are kept for the whole run, workers are reported with the largest one
+inline static void arena_stats(size_t* mainPeak, size_t* workerPeak, uint32_t* overflows) {
+	*mainPeak = 0;
+	*workerPeak = 0;
+	*overflows = 0;
+
+	for (uint32_t i = 0; i < arenaCount; i++) {
+		if (i == 0)
+			*mainPeak = arenas[i].peak;
+		else if (*workerPeak < arenas[i].peak)
+			*workerPeak = arenas[i].peak;
+
+		*overflows += arenas[i].overflows;
+	}
+}
+
+// Profiling
+
+#define PROFILER_POLL 0
+#define PROFILER_DECODE 1
+#define PROFILER_MOVE 2
+#define PROFILER_SEND 3
+#define PROFILER_FLUSH 4
+#define PROFILER_RENDER 5
+#define PROFILER_PHASES 6
+#define PROFILER_SAMPLES 128
+#define PROFILER_REFRESH 30
+
+typedef struct _ProfilerStats {
+	float minimum;
+	float average;
+	float percentile;
+} ProfilerStats;
+
+typedef struct _Profiler {
+	uint64_t current[PROFILER_PHASES];
+	float samples[PROFILER_PHASES][PROFILER_SAMPLES];
+	ProfilerStats stats[PROFILER_PHASES];
+	uint32_t frames;
+} Profiler;
+
+static Profiler profiler;
+
+static const char* profilerPhases[PROFILER_PHASES] = { "POLL", "DECODE", "MOVE", "SEND", "FLUSH", "RENDER" };
+
+inline static uint64_t profiler_ticks(void) {
+	uint64_t ticks = 0;
+
+	if (settings.profiler > 0)
+		aws_high_res_clock_get_ticks(&ticks);
+
+	return ticks;
+}
+
+// Phases may be recorded several times per frame, the time is accumulated until the frame ends
+inline static void profiler_record(uint32_t phase, uint64_t startTime) {
+	if (settings.profiler > 0)
+		profiler.current[phase] += profiler_ticks() - startTime;
+}
+
+static int profiler_compare(const void* left, const void* right) {
+	float a = *(const float*)left, b = *(const float*)right;
+
+	return (a > b) - (a < b);
+}
+
+inline static void profiler_frame(void) {
+	if (settings.profiler == 0)
+		return;
+
+	// Decoding happens inside the polling loop
+	profiler.current[PROFILER_POLL] -= (profiler.current[PROFILER_DECODE] < profiler.current[PROFILER_POLL]) ? profiler.current[PROFILER_DECODE] : profiler.current[PROFILER_POLL];
+
+	uint32_t sample = profiler.frames++ % PROFILER_SAMPLES;
+
+	for (uint32_t i = 0; i < PROFILER_PHASES; i++) {
+		profiler.samples[i][sample] = profiler.current[i] / 1000000.0f;
+		profiler.current[i] = 0;
+	}
+
+	if (profiler.frames % PROFILER_REFRESH != 0)
+		return;
+
+	uint32_t count = (profiler.frames < PROFILER_SAMPLES) ? profiler.frames : PROFILER_SAMPLES;
+	float sorted[PROFILER_SAMPLES];
+
+	for (uint32_t i = 0; i < PROFILER_PHASES; i++) {
+		float total = 0.0f;
+
+		memcpy(sorted, profiler.samples[i], sizeof(float) * count);
+		qsort(sorted, count, sizeof(float), profiler_compare);
+
+		for (uint32_t j = 0; j < count; j++) {
+			total += sorted[j];
+		}
+
+		profiler.stats[i].minimum = sorted[0];
+		profiler.stats[i].average = total / count;
+		profiler.stats[i].percentile = sorted[((count * 99 + 99) / 100) - 1];
+	}
+}
+
+// Metrics without a file own the standard output, so the text reports move to the standard error
+inline static FILE* report_stream(void) {
+	return (settings.metrics > NET_METRICS_NONE && settings.metricsFile == NULL) ? stderr : stdout;
+}
+
+// Headless mode has no overlay, so the same values are printed as text
+inline static void profiler_print(void) {
+	FILE* stream = report_stream();
+
+	fprintf(stream, "FRAME %u", profiler.frames);
+
+	for (uint32_t i = 0; i < PROFILER_PHASES; i++) {
+		fprintf(stream, " | %s %.3f/%.3f/%.3f ms", profilerPhases[i], profiler.stats[i].minimum, profiler.stats[i].average, profiler.stats[i].percentile);
+	}
+
+	if (settings.arena > 0) {
+		size_t mainPeak, workerPeak;
+		uint32_t overflows;
+
+		arena_stats(&mainPeak, &workerPeak, &overflows);
+		fprintf(stream, " | ARENA %.1f/%.1f KB %u overflows", mainPeak / 1024.0f, workerPeak / 1024.0f, overflows);
+	}
+
+	fprintf(stream, "\n");
+	fflush(stream);
+}
+
+// Metrics
+
+#define METRICS_LINE_SIZE 512
+
+typedef struct _MetricsPeer {
+	uint32_t id;
+	uint32_t rtt;
+	uint32_t packetsSent;
+	uint32_t packetsLost;
+	float throttle;
+} MetricsPeer;
+
+typedef struct _MetricsRecord {
+	uint64_t time;
+	float tickTime;
+	float worstTickTime;
+	uint32_t entities;
+	uint32_t messagesSent;
+	uint32_t messagesReceived;
+	uint64_t bytesSent;
+	uint64_t bytesReceived;
+	uint32_t peerCount;
+	MetricsPeer peers[NET_MAX_CLIENTS];
+} MetricsRecord;
+
+typedef struct _Metrics {
+	FILE* file;
+	MetricsRecord record;
+	uint64_t startTime;
+	uint64_t sampleTime;
+	uint64_t tickTicks;
+	uint64_t worstTickTicks;
+	uint32_t ticks;
+	uint32_t messagesSent;
+	uint32_t messagesReceived;
+	uint64_t bytesSent;
+	uint64_t bytesReceived;
+	uint64_t totalMessagesSent;
+	uint64_t totalMessagesReceived;
+	uint64_t totalBytesSent;
+	uint64_t totalBytesReceived;
+	char line[METRICS_LINE_SIZE];
+	char buffer[64 * 1024];
+} Metrics;
+
+static Metrics metrics;
+
+// Counters are only touched by the main thread, packets in thread mode are counted when they are queued
+inline static void metrics_sent(size_t length, uint32_t receivers) {
+	metrics.messagesSent += receivers;
+	metrics.bytesSent += length * receivers;
+	metrics.totalMessagesSent += receivers;
+	metrics.totalBytesSent += length * receivers;
+}
+
+inline static void metrics_received(size_t length) {
+	metrics.messagesReceived++;
+	metrics.bytesReceived += length;
+	metrics.totalMessagesReceived++;
+	metrics.totalBytesReceived += length;
+}
+
+inline static uint64_t metrics_ticks(void) {
+	uint64_t ticks = 0;
+
+	if (settings.metrics > NET_METRICS_NONE)
+		aws_high_res_clock_get_ticks(&ticks);
+
+	return ticks;
+}
+
+inline static void metrics_tick(uint64_t startTime) {
+	if (settings.metrics == NET_METRICS_NONE)
+		return;
+
+	uint64_t elapsed = metrics_ticks() - startTime;
+
+	metrics.tickTicks += elapsed;
+	metrics.ticks++;
+
+	if (metrics.worstTickTicks < elapsed)
+		metrics.worstTickTicks = elapsed;
+}
+
+// The file is fully buffered by a static buffer, so stdio doesn't allocate either
+inline static bool metrics_open(void) {
+	if (settings.metrics == NET_METRICS_NONE)
+		return true;
+
+	metrics.file = (settings.metricsFile != NULL) ? fopen(settings.metricsFile, "w") : stdout;
+
+	if (metrics.file == NULL)
+		return false;
+
+	setvbuf(metrics.file, metrics.buffer, _IOFBF, sizeof(metrics.buffer));
+
+	if (settings.metrics == NET_METRICS_CSV)
+		fputs("time,tick_ms,worst_tick_ms,entities,messages_sent,messages_received,bytes_sent,bytes_received,peer,rtt,packets_sent,packets_lost,throttle\n", metrics.file);
+
+	aws_high_res_clock_get_ticks(&metrics.startTime);
+
+	metrics.sampleTime = metrics.startTime;
+
+	return true;
+}
+
+inline static void metrics_close(void) {
+	if (metrics.file == NULL)
+		return;
+
+	fflush(metrics.file);
+
+	if (metrics.file != stdout)
+		fclose(metrics.file);
+
+	metrics.file = NULL;
+}
+
+inline static void metrics_write(const char* format, ...) {
+	va_list arguments;
+
+	va_start(arguments, format);
+
+	int length = vsnprintf(metrics.line, sizeof(metrics.line), format, arguments);
+
+	va_end(arguments);
+
+	if (length > 0)
+		fwrite(metrics.line, 1, (length < METRICS_LINE_SIZE) ? (size_t)length : METRICS_LINE_SIZE - 1, metrics.file);
+}
+
+inline static void metrics_emit(const MetricsRecord* record) {
+	double time = record->time / 1000000000.0;
+
+	if (settings.metrics == NET_METRICS_CSV) {
+		if (record->peerCount == 0)
+			metrics_write("%.3f,%.3f,%.3f,%u,%u,%u,%llu,%llu,,,,,\n", time, record->tickTime, record->worstTickTime, record->entities, record->messagesSent, record->messagesReceived, (unsigned long long)record->bytesSent, (unsigned long long)record->bytesReceived);
+
+		for (uint32_t i = 0; i < record->peerCount; i++) {
+			const MetricsPeer* peer = &record->peers[i];
+
+			metrics_write("%.3f,%.3f,%.3f,%u,%u,%u,%llu,%llu,%u,%u,%u,%u,%.3f\n", time, record->tickTime, record->worstTickTime, record->entities, record->messagesSent, record->messagesReceived, (unsigned long long)record->bytesSent, (unsigned long long)record->bytesReceived, peer->id, peer->rtt, peer->packetsSent, peer->packetsLost, peer->throttle);
+		}
+	} else if (settings.metrics == NET_METRICS_JSON) {
+		metrics_write("{\"time\":%.3f,\"tick_ms\":%.3f,\"worst_tick_ms\":%.3f,\"entities\":%u,\"messages_sent\":%u,\"messages_received\":%u,\"bytes_sent\":%llu,\"bytes_received\":%llu,\"peers\":[", time, record->tickTime, record->worstTickTime, record->entities, record->messagesSent, record->messagesReceived, (unsigned long long)record->bytesSent, (unsigned long long)record->bytesReceived);
+
+		for (uint32_t i = 0; i < record->peerCount; i++) {
+			const MetricsPeer* peer = &record->peers[i];
+
+			metrics_write("%s{\"id\":%u,\"rtt\":%u,\"packets_sent\":%u,\"packets_lost\":%u,\"throttle\":%.3f}", (i > 0) ? "," : "", peer->id, peer->rtt, peer->packetsSent, peer->packetsLost, peer->throttle);
+		}
+
+		metrics_write("]}\n");
+	}
+
+	fflush(metrics.file);
+}
+
+inline static void metrics_peer(MetricsRecord* record, void* peer) {
+	TransportStats stats = { 0 };
+
+	if (!transport->stats(peer, &stats) || !stats.connected)
+		return;
+
+	MetricsPeer* metricsPeer = &record->peers[record->peerCount++];
+
+	metricsPeer->id = stats.id;
+	metricsPeer->rtt = stats.rtt;
+	metricsPeer->packetsSent = stats.packetsSent;
+	metricsPeer->packetsLost = stats.packetsLost;
+	metricsPeer->throttle = stats.throttle;
+}
+
+// Rates are normalized to per second over the actual length of the interval
+inline static void metrics_update(void) {
+	if (metrics.file == NULL)
+		return;
+
+	uint64_t currentTime = 0;
+
+	aws_high_res_clock_get_ticks(&currentTime);
+
+	uint64_t elapsed = currentTime - metrics.sampleTime;
+
+	if (elapsed < (uint64_t)settings.metricsInterval * 1000000)
+		return;
+
+	double scale = 1000000000.0 / elapsed;
+
+	MetricsRecord* record = &metrics.record;
+
+	record->time = currentTime - metrics.startTime;
+	record->tickTime = (metrics.ticks > 0) ? (metrics.tickTicks / (float)metrics.ticks) / 1000000.0f : 0.0f;
+	record->worstTickTime = metrics.worstTickTicks / 1000000.0f;
+	record->entities = entities.count;
+	record->messagesSent = (uint32_t)(metrics.messagesSent * scale);
+	record->messagesReceived = (uint32_t)(metrics.messagesReceived * scale);
+	record->bytesSent = (uint64_t)(metrics.bytesSent * scale);
+	record->bytesReceived = (uint64_t)(metrics.bytesReceived * scale);
+	record->peerCount = 0;
+
+	#ifdef NETDYNAMICS_SERVER
+		for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+			if (clients[i] != NULL)
+				metrics_peer(record, clients[i]);
+		}
+	#elif NETDYNAMICS_CLIENT
+		metrics_peer(record, NULL);
+	#endif
+
+	metrics.sampleTime = currentTime;
+	metrics.tickTicks = 0;
+	metrics.worstTickTicks = 0;
+	metrics.ticks = 0;
+	metrics.messagesSent = 0;
+	metrics.messagesReceived = 0;
+	metrics.bytesSent = 0;
+	metrics.bytesReceived = 0;
+
+	metrics_emit(record);
+}
+
+// Channels
+
+typedef struct _ChannelCounter {
+	uint32_t messages;
+	uint64_t bytes;
+	uint32_t messageRate;
+	uint64_t byteRate;
+} ChannelCounter;
+
+// Control and bulk traffic is reliable, state is superseded by the next update and never waits for a retransmission
+static const bool channelReliable[NET_CHANNELS] = { true, false, true };
+static const char* channelNames[NET_CHANNELS] = { "CONTROL", "STATE", "BULK" };
+static ChannelCounter channelCounters[NET_CHANNELS];
+static float channelTimes[NET_CHANNELS];
+static float channelElapsed;
+
+inline static void channel_sent(uint8_t channel, size_t length, uint32_t receivers) {
+	channelCounters[channel].messages += receivers;
+	channelCounters[channel].bytes += length * receivers;
+}
+
+// A rate of zero sends every tick, a late channel sends once instead of catching up
+inline static bool channel_due(uint8_t channel, float deltaTime) {
+	if (settings.channelRates[channel] == 0)
+		return true;
+
+	float interval = 1.0f / settings.channelRates[channel];
+
+	channelTimes[channel] += deltaTime;
+
+	if (channelTimes[channel] < interval)
+		return false;
+
+	channelTimes[channel] -= interval;
+
+	if (channelTimes[channel] > interval)
+		channelTimes[channel] = 0.0f;
+
+	return true;
+}
+
+inline static void channel_update(float deltaTime) {
+	channelElapsed += deltaTime;
+
+	if (channelElapsed < 1.0f)
+		return;
+
+	for (uint32_t i = 0; i < NET_CHANNELS; i++) {
+		channelCounters[i].messageRate = (uint32_t)(channelCounters[i].messages / channelElapsed);
+		channelCounters[i].byteRate = (uint64_t)(channelCounters[i].bytes / channelElapsed);
+		channelCounters[i].messages = 0;
+		channelCounters[i].bytes = 0;
+	}
+
+	channelElapsed = 0.0f;
+}
+
+// Capture
+
+#define CAPTURE_MAGIC 0x5043444E
+#define CAPTURE_VERSION 1
+#define CAPTURE_EVENT_SEND 4
+#define CAPTURE_BROADCAST UINT8_MAX
+
+#ifdef NETDYNAMICS_SERVER
+	#define CAPTURE_FLAVOR 0
+#elif NETDYNAMICS_CLIENT
+	#define CAPTURE_FLAVOR 1
+#endif
+
+// Fields are stored in the byte order of the machine, records are unaligned and copied in and out
+typedef struct _CaptureHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint8_t flavor;
+	uint8_t reserved;
+} CaptureHeader;
+
+typedef struct _CaptureRecord {
+	uint64_t time;
+	uint32_t length;
+	uint8_t type;
+	uint8_t peer;
+	uint8_t reliable;
+	uint8_t reserved;
+} CaptureRecord;
+
+typedef struct _MappedFile {
+	uint8_t* memory;
+	size_t size;
+	#ifdef _WIN32
+		HANDLE file;
+		HANDLE mapping;
+	#else
+		int file;
+	#endif
+} MappedFile;
+
+typedef struct _Capture {
+	MappedFile log;
+	size_t offset;
+	uint64_t startTime;
+	bool active;
+} Capture;
+
+static Capture capture;
+
+inline static void mapped_file_unmap(MappedFile* file) {
+	if (file->memory == NULL)
+		return;
+
+	#ifdef _WIN32
+		UnmapViewOfFile(file->memory);
+		CloseHandle(file->mapping);
+
+		file->mapping = NULL;
+	#else
+		munmap(file->memory, file->size);
+	#endif
+
+	file->memory = NULL;
+}
+
+// Writable mappings extend the file to the size, read mappings are private copies of the whole file
+inline static bool mapped_file_map(MappedFile* file, size_t size, bool writable) {
+	#ifdef _WIN32
+		if (!writable) {
+			LARGE_INTEGER fileSize;
+
+			if (!GetFileSizeEx(file->file, &fileSize))
+				return false;
+
+			size = (size_t)fileSize.QuadPart;
+		}
+
+		if (size == 0 || (file->mapping = CreateFileMappingA(file->file, NULL, writable ? PAGE_READWRITE : PAGE_WRITECOPY, (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL)) == NULL)
+			return false;
+
+		if ((file->memory = (uint8_t*)MapViewOfFile(file->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, size)) == NULL) {
+			CloseHandle(file->mapping);
+
+			file->mapping = NULL;
+
+			return false;
+		}
+	#else
+		if (writable) {
+			if (ftruncate(file->file, (off_t)size) != 0)
+				return false;
+		} else {
+			struct stat status;
+
+			if (fstat(file->file, &status) != 0)
+				return false;
+
+			size = (size_t)status.st_size;
+		}
+
+		void* memory = (size > 0) ? mmap(NULL, size, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, file->file, 0) : MAP_FAILED;
+
+		if (memory == MAP_FAILED)
+			return false;
+
+		file->memory = (uint8_t*)memory;
+	#endif
+
+	file->size = size;
+
+	return true;
+}
+
+inline static bool mapped_file_open(MappedFile* file, const char* path, size_t size, bool writable) {
+	memset(file, 0, sizeof(MappedFile));
+
+	#ifdef _WIN32
+		if ((file->file = CreateFileA(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, NULL, writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL)) == INVALID_HANDLE_VALUE)
+			return false;
+	#else
+		if ((file->file = open(path, writable ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644)) < 0)
+			return false;
+	#endif
+
+	if (mapped_file_map(file, size, writable))
+		return true;
+
+	#ifdef _WIN32
+		CloseHandle(file->file);
+
+		file->file = NULL;
+	#else
+		close(file->file);
+
+		file->file = 0;
+	#endif
+
+	return false;
+}
+
+// Writable files are truncated to the used length, so the tail of the last chunk isn't left behind
+inline static bool mapped_file_close(MappedFile* file, size_t length, bool writable) {
+	bool truncated = true;
+
+	mapped_file_unmap(file);
+
+	#ifdef _WIN32
+		if (file->file == INVALID_HANDLE_VALUE || file->file == NULL)
+			return false;
+
+		if (writable) {
+			LARGE_INTEGER position;
+
+			position.QuadPart = (LONGLONG)length;
+			truncated = SetFilePointerEx(file->file, position, NULL, FILE_BEGIN) && SetEndOfFile(file->file);
+		}
+
+		CloseHandle(file->file);
+
+		file->file = NULL;
+	#else
+		if (file->file <= 0)
+			return false;
+
+		if (writable)
+			truncated = ftruncate(file->file, (off_t)length) == 0;
+
+		close(file->file);
+
+		file->file = 0;
+	#endif
+
+	return truncated;
+}
+
+inline static bool capture_open(void) {
+	if (settings.captureFile == NULL)
+		return true;
+
+	if (!mapped_file_open(&capture.log, settings.captureFile, NET_CAPTURE_CHUNK, true))
+		return false;
+
+	CaptureHeader header = { CAPTURE_MAGIC, CAPTURE_VERSION, CAPTURE_FLAVOR, 0 };
+
+	memcpy(capture.log.memory, &header, sizeof(header));
+	aws_high_res_clock_get_ticks(&capture.startTime);
+
+	capture.offset = sizeof(header);
+	capture.active = true;
+
+	return true;
+}
+
+inline static void capture_close(void) {
+	if (!capture.active)
+		return;
+
+	mapped_file_close(&capture.log, capture.offset, true);
+
+	capture.active = false;
+}
+
+// The mapping grows by remapping a larger file, a failure stops the capture rather than the application
+inline static void capture_record(uint8_t type, uint32_t peer, bool reliable, const uint8_t* data, size_t length) {
+	if (!capture.active)
+		return;
+
+	#ifdef NETDYNAMICS_CLIENT
+		if (loadCurrent != 0)
+			return;
+	#endif
+
+	size_t required = capture.offset + sizeof(CaptureRecord) + length;
+
+	if (required > capture.log.size) {
+		size_t size = capture.log.size * 2;
+
+		while (size < required) {
+			size *= 2;
+		}
+
+		mapped_file_unmap(&capture.log);
+
+		if (!mapped_file_map(&capture.log, size, true)) {
+			mapped_file_close(&capture.log, capture.offset, true);
+
+			capture.active = false;
+
+			return;
+		}
+	}
+
+	uint64_t currentTime = 0;
+
+	aws_high_res_clock_get_ticks(&currentTime);
+
+	CaptureRecord record = { currentTime - capture.startTime, (uint32_t)length, type, (uint8_t)peer, reliable, 0 };
+
+	memcpy(capture.log.memory + capture.offset, &record, sizeof(record));
+
+	if (length > 0)
+		memcpy(capture.log.memory + capture.offset + sizeof(record), data, length);
+
+	capture.offset = required;
+}
+
+// Threading
+
+typedef struct _Ring {
+	struct aws_atomic_var head;
+	uint8_t headPadding[64 - sizeof(struct aws_atomic_var)];
+	struct aws_atomic_var tail;
+	uint8_t tailPadding[64 - sizeof(struct aws_atomic_var)];
+	uint8_t* buffer;
+	size_t elementSize;
+	size_t mask;
+} Ring;
+
+typedef struct _NetworkCommand {
+	ENetPeer* peer; // Broadcast if null
+	ENetPacket* packet;
+	uint8_t channel;
+} NetworkCommand;
+
+typedef struct _NetworkSnapshot {
+	struct aws_mutex mutex;
+	TransportStats* peers; // Indexed by the incoming peer id
+	size_t peerCount;
+	size_t connected;
+	uint32_t time; // Only touched by the network thread
+} NetworkSnapshot;
+
+static struct aws_thread networkThread;
+static struct aws_atomic_var networkRunning;
+static Ring networkInbound;
+static Ring networkOutbound;
+static NetworkSnapshot networkSnapshot;
+
+inline static bool ring_create(Ring* ring, size_t capacity, size_t elementSize) {
+	aws_atomic_init_int(&ring->head, 0);
+	aws_atomic_init_int(&ring->tail, 0);
+
+	ring->buffer = (uint8_t*)je_malloc(capacity * elementSize);
+	ring->elementSize = elementSize;
+	ring->mask = capacity - 1;
+
+	return ring->buffer != NULL;
+}
+
+inline static void ring_destroy(Ring* ring) {
+	je_free(ring->buffer);
+
+	ring->buffer = NULL;
+}
+
+// Single producer and single consumer, the head is only written by the consumer and the tail by the producer
+
+inline static bool ring_push(Ring* ring, const void* element) {
+	size_t tail = aws_atomic_load_int_explicit(&ring->tail, aws_memory_order_relaxed);
+
+	if (tail - aws_atomic_load_int_explicit(&ring->head, aws_memory_order_acquire) > ring->mask)
+		return false;
+
+	memcpy(ring->buffer + (tail & ring->mask) * ring->elementSize, element, ring->elementSize);
+
+	aws_atomic_store_int_explicit(&ring->tail, tail + 1, aws_memory_order_release);
+
+	return true;
+}
+
+inline static bool ring_pop(Ring* ring, void* element) {
+	size_t head = aws_atomic_load_int_explicit(&ring->head, aws_memory_order_relaxed);
+
+	if (head == aws_atomic_load_int_explicit(&ring->tail, aws_memory_order_acquire))
+		return false;
+
+	memcpy(element, ring->buffer + (head & ring->mask) * ring->elementSize, ring->elementSize);
+
+	aws_atomic_store_int_explicit(&ring->head, head + 1, aws_memory_order_release);
+
+	return true;
+}
+
+inline static void network_peer_stats(ENetPeer* peer, TransportStats* stats) {
+	stats->id = peer->incomingPeerID;
+	stats->rtt = peer->roundTripTime;
+	stats->packetsSent = peer->totalPacketsSent;
+	stats->packetsLost = peer->totalPacketsLost;
+	stats->throttle = enet_peer_get_packets_throttle(peer);
+	stats->connected = peer->state == ENET_PEER_STATE_CONNECTED;
+}
+
+// Host and peers are owned by the network thread, the main thread only reads the copy published here at most once per millisecond
+inline static void network_publish(bool force) {
+	uint32_t time = enet_time_get();
+
+	if (!force && time == networkSnapshot.time)
+		return;
+
+	networkSnapshot.time = time;
+
+	aws_mutex_lock(&networkSnapshot.mutex);
+
+	for (size_t i = 0; i < networkSnapshot.peerCount; i++) {
+		network_peer_stats(&enetHost->peers[i], &networkSnapshot.peers[i]);
+	}
+
+	networkSnapshot.connected = enetHost->connectedPeers;
+
+	aws_mutex_unlock(&networkSnapshot.mutex);
+}
+
+inline static void network_dispatch(void) {
+	NetworkCommand command;
+	bool sent = false;
+
+	while (ring_pop(&networkOutbound, &command)) {
+		if (command.peer == NULL)
+			enet_host_broadcast(enetHost, command.channel, command.packet);
+		else if (enet_peer_send(command.peer, command.channel, command.packet) < 0)
+			enet_packet_destroy(command.packet);
+
+		sent = true;
+	}
+
+	if (sent)
+		enet_host_flush(enetHost);
+}
+
+static void network_thread(void* data) {
+	ENetEvent event = { 0 };
+
+	while (aws_atomic_load_int_explicit(&networkRunning, aws_memory_order_acquire) != 0) {
+		network_dispatch();
+
+		if (enet_host_check_events(enetHost, &event) <= 0 && enet_host_service(enetHost, &event, NET_THREAD_SERVICE_TIMEOUT) <= 0) {
+			network_publish(false);
+
+			continue;
+		}
+
+		// Connection changes are published before the event so the main thread sees a matching count
+		network_publish(event.type != ENET_EVENT_TYPE_RECEIVE);
+
+		// Stall the transport rather than dropping events when the main thread falls behind, but keep sending so it can't block on a full outbound queue
+		while (!ring_push(&networkInbound, &event)) {
+			if (aws_atomic_load_int_explicit(&networkRunning, aws_memory_order_acquire) == 0) {
+				if (event.type == ENET_EVENT_TYPE_RECEIVE)
+					enet_packet_destroy(event.packet);
+
+				break;
+			}
+
+			network_dispatch();
+			aws_thread_yield();
+		}
+	}
+}
+
+inline static bool network_thread_start(void) {
+	if (!ring_create(&networkInbound, NET_THREAD_INBOUND_CAPACITY, sizeof(ENetEvent)) || !ring_create(&networkOutbound, NET_THREAD_OUTBOUND_CAPACITY, sizeof(NetworkCommand)))
+		return false;
+
+	if ((networkSnapshot.peers = (TransportStats*)je_calloc(enetHost->peerCount, sizeof(TransportStats))) == NULL)
+		return false;
+
+	if (aws_mutex_init(&networkSnapshot.mutex) != AWS_OP_SUCCESS) {
+		je_free(networkSnapshot.peers);
+
+		networkSnapshot.peers = NULL;
+
+		return false;
+	}
+
+	networkSnapshot.peerCount = enetHost->peerCount;
+
+	network_publish(true);
+
+	aws_atomic_init_int(&networkRunning, 1);
+
+	if (aws_thread_init(&networkThread, aws_default_allocator()) != AWS_OP_SUCCESS || aws_thread_launch(&networkThread, network_thread, NULL, NULL) != AWS_OP_SUCCESS) {
+		aws_atomic_store_int(&networkRunning, 0);
+
+		return false;
+	}
+
+	return true;
+}
+
+inline static void network_thread_stop(void) {
+	ENetEvent event;
+	NetworkCommand command;
+
+	if (aws_atomic_exchange_int(&networkRunning, 0) != 0) {
+		aws_thread_join(&networkThread);
+		aws_thread_clean_up(&networkThread);
+	}
+
+	if (networkInbound.buffer != NULL) {
+		while (ring_pop(&networkInbound, &event)) {
+			if (event.type == ENET_EVENT_TYPE_RECEIVE)
+				enet_packet_destroy(event.packet);
+		}
+	}
+
+	if (networkOutbound.buffer != NULL) {
+		while (ring_pop(&networkOutbound, &command)) {
+			enet_packet_destroy(command.packet);
+		}
+	}
+
+	ring_destroy(&networkInbound);
+	ring_destroy(&networkOutbound);
+
+	if (networkSnapshot.peers != NULL) {
+		aws_mutex_clean_up(&networkSnapshot.mutex);
+		je_free(networkSnapshot.peers);
+	}
+
+	memset(&networkSnapshot, 0, sizeof(networkSnapshot));
+}
+
+inline static void network_enqueue(ENetPeer* peer, ENetPacket* packet, uint8_t channel) {
+	NetworkCommand command = { peer, packet, channel };
+
+	while (!ring_push(&networkOutbound, &command)) {
+		aws_thread_yield();
+	}
+}
+
+inline static void network_flush(void) {
+	if (settings.networkThread == 0) {
+		uint64_t flushTime = profiler_ticks();
+
+		enet_host_flush(enetHost);
+
+		profiler_record(PROFILER_FLUSH, flushTime);
+	}
+}
+
+// Jobs
+
+typedef struct _PacketList {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+	uint32_t* lengths;
+	uint32_t count;
+	uint32_t limit;
+} PacketList;
+
+// Finished packets in order, each one is a pooled buffer that is submitted as it is
+typedef struct _PacketQueue {
+	uint8_t** buffers;
+	uint32_t* lengths;
+	uint32_t count;
+	uint32_t limit;
+} PacketQueue;
+
+typedef struct _Job {
+	uint32_t first;
+	uint32_t last;
+	PacketQueue packets;
+} Job;
+
+typedef void (*JobFunction)(Job* job);
+
+typedef struct _JobPool {
+	struct aws_thread threads[NET_MAX_WORKERS];
+	uint32_t threadCount;
+	Job* jobs;
+	uint32_t jobCount;
+	JobFunction function;
+	uint32_t dispatched;
+	uint32_t next;
+	uint32_t pending;
+	uint64_t generation;
+	bool running;
+	struct aws_mutex mutex;
+	struct aws_condition_variable wake;
+	struct aws_condition_variable finished;
+} JobPool;
+
+static JobPool jobPool;
+
+// Returns space for a packet of up to the given size, committed afterwards with its actual length
+inline static uint8_t* packet_list_reserve(PacketList* list, size_t size) {
+	if (list->size + size > list->capacity) {
+		size_t capacity = (list->capacity > 0) ? list->capacity * 2 : 64 * 1024;
+
+		while (capacity < list->size + size) {
+			capacity *= 2;
+		}
+
+		uint8_t* data = (uint8_t*)je_realloc(list->data, capacity);
+
+		if (data == NULL)
+			return NULL;
+
+		list->data = data;
+		list->capacity = capacity;
+	}
+
+	if (list->count == list->limit) {
+		uint32_t limit = (list->limit > 0) ? list->limit * 2 : 64;
+		uint32_t* lengths = (uint32_t*)je_realloc(list->lengths, sizeof(uint32_t) * limit);
+
+		if (lengths == NULL)
+			return NULL;
+
+		list->lengths = lengths;
+		list->limit = limit;
+	}
+
+	return list->data + list->size;
+}
+
+inline static void packet_list_commit(PacketList* list, size_t length) {
+	list->lengths[list->count++] = (uint32_t)length;
+	list->size += length;
+}
+
+// Jobs are claimed under the lock, which is cheap compared to serializing thousands of entities per job
+inline static void job_pool_work(uint64_t generation) {
+	while (jobPool.generation == generation && jobPool.next < jobPool.dispatched) {
+		Job* job = &jobPool.jobs[jobPool.next++];
+
+		aws_mutex_unlock(&jobPool.mutex);
+
+		jobPool.function(job);
+
+		aws_mutex_lock(&jobPool.mutex);
+
+		if (--jobPool.pending == 0)
+			aws_condition_variable_notify_all(&jobPool.finished);
+	}
+}
+
+static void job_worker(void* data) {
+	uint64_t generation = 0;
+
+	arenaCurrent = (Arena*)data;
+
+	aws_mutex_lock(&jobPool.mutex);
+
+	while (true) {
+		while (jobPool.running && jobPool.generation == generation) {
+			aws_condition_variable_wait(&jobPool.wake, &jobPool.mutex);
+		}
+
+		if (!jobPool.running)
+			break;
+
+		generation = jobPool.generation;
+
+		job_pool_work(generation);
+	}
+
+	aws_mutex_unlock(&jobPool.mutex);
+}
+
+inline static void job_pool_stop(void) {
+	if (jobPool.jobs == NULL)
+		return;
+
+	aws_mutex_lock(&jobPool.mutex);
+
+	jobPool.running = false;
+
+	aws_condition_variable_notify_all(&jobPool.wake);
+	aws_mutex_unlock(&jobPool.mutex);
+
+	for (uint32_t i = 0; i < jobPool.threadCount; i++) {
+		aws_thread_join(&jobPool.threads[i]);
+		aws_thread_clean_up(&jobPool.threads[i]);
+	}
+
+	for (uint32_t i = 0; i < jobPool.jobCount; i++) {
+		je_free(jobPool.jobs[i].packets.buffers);
+		je_free(jobPool.jobs[i].packets.lengths);
+	}
+
+	aws_condition_variable_clean_up(&jobPool.finished);
+	aws_condition_variable_clean_up(&jobPool.wake);
+	aws_mutex_clean_up(&jobPool.mutex);
+
+	je_free(jobPool.jobs);
+
+	memset(&jobPool, 0, sizeof(jobPool));
+}
+
+inline static bool job_pool_start(uint32_t workers) {
+	if (workers > NET_MAX_WORKERS)
+		workers = NET_MAX_WORKERS;
+
+	jobPool.jobCount = (workers + 1) * NET_JOBS_PER_WORKER;
+
+	if ((jobPool.jobs = (Job*)je_calloc(jobPool.jobCount, sizeof(Job))) == NULL)
+		return false;
+
+	bool mutex = aws_mutex_init(&jobPool.mutex) == AWS_OP_SUCCESS;
+	bool wake = mutex && aws_condition_variable_init(&jobPool.wake) == AWS_OP_SUCCESS;
+	bool finished = wake && aws_condition_variable_init(&jobPool.finished) == AWS_OP_SUCCESS;
+
+	if (!finished) {
+		if (wake)
+			aws_condition_variable_clean_up(&jobPool.wake);
+
+		if (mutex)
+			aws_mutex_clean_up(&jobPool.mutex);
+
+		je_free(jobPool.jobs);
+
+		memset(&jobPool, 0, sizeof(jobPool));
+
+		return false;
+	}
+
+	jobPool.running = true;
+
+	for (uint32_t i = 0; i < workers; i++) {
+		if (aws_thread_init(&jobPool.threads[i], aws_default_allocator()) != AWS_OP_SUCCESS)
+			break;
+
+		if (aws_thread_launch(&jobPool.threads[i], job_worker, &arenas[i + 1], NULL) != AWS_OP_SUCCESS) {
+			aws_thread_clean_up(&jobPool.threads[i]);
+
+			break;
+		}
+
+		jobPool.threadCount++;
+	}
+
+	// Workers that did start are joined before the pool is torn down
+	if (jobPool.threadCount < workers) {
+		job_pool_stop();
+
+		return false;
+	}
+
+	return true;
+}
+
+// Splits the range into chunks for the workers, the calling thread takes its share and returns once all of them are done
+inline static uint32_t job_pool_run(JobFunction function, uint32_t first, uint32_t last) {
+	uint32_t chunks = jobPool.jobCount;
+	uint32_t chunkSize = (last - first + chunks - 1) / chunks;
+
+	if (chunkSize == 0)
+		chunkSize = 1;
+
+	aws_mutex_lock(&jobPool.mutex);
+
+	jobPool.dispatched = 0;
+
+	for (uint32_t i = first; i < last; i += chunkSize) {
+		Job* job = &jobPool.jobs[jobPool.dispatched++];
+
+		job->first = i;
+		job->last = (last - i < chunkSize) ? last : i + chunkSize;
+		job->packets.count = 0;
+	}
+
+	jobPool.function = function;
+	jobPool.next = 0;
+	jobPool.pending = jobPool.dispatched;
+	jobPool.generation++;
+
+	aws_condition_variable_notify_all(&jobPool.wake);
+
+	job_pool_work(jobPool.generation);
+
+	while (jobPool.pending > 0) {
+		aws_condition_variable_wait(&jobPool.finished, &jobPool.mutex);
+	}
+
+	aws_mutex_unlock(&jobPool.mutex);
+
+	return jobPool.dispatched;
+}
+
+// Packets
+
+#define PACKET_POOL_CLASSES (NET_PACKET_POOL_MAX_SHIFT - NET_PACKET_POOL_MIN_SHIFT + 1)
+#define PACKET_POOL_OVERSIZE PACKET_POOL_CLASSES
+
+typedef struct _PacketBlock {
+	struct _PacketBlock* next;
+	uint64_t sizeClass; // Also keeps the data behind the header aligned
+} PacketBlock;
+
+typedef struct _PacketPool {
+	PacketBlock* free[PACKET_POOL_CLASSES];
+	struct aws_mutex mutex;
+} PacketPool;
+
+static PacketPool packetPool;
+
+#define PACKET_BLOCK(data) ((PacketBlock*)(data) - 1)
+
+inline static uint32_t packet_pool_class(size_t size) {
+	uint32_t sizeClass = 0;
+
+	while (sizeClass < PACKET_POOL_CLASSES && ((size_t)1 << (sizeClass + NET_PACKET_POOL_MIN_SHIFT)) < size) {
+		sizeClass++;
+	}
+
+	return sizeClass;
+}
+
+inline static PacketBlock* packet_block_create(uint32_t sizeClass, size_t size) {
+	PacketBlock* block = (PacketBlock*)je_malloc(sizeof(PacketBlock) + ((sizeClass < PACKET_POOL_CLASSES) ? (size_t)1 << (sizeClass + NET_PACKET_POOL_MIN_SHIFT) : size));
+
+	if (block != NULL)
+		block->sizeClass = sizeClass;
+
+	return block;
+}
+
+inline static bool packet_pool_create(void) {
+	if (aws_mutex_init(&packetPool.mutex) != AWS_OP_SUCCESS)
+		return false;
+
+	for (uint32_t i = 0; i < PACKET_POOL_CLASSES; i++) {
+		uint32_t blocks = NET_PACKET_POOL_WARM_BYTES >> (i + NET_PACKET_POOL_MIN_SHIFT);
+
+		for (uint32_t j = 0; j < blocks; j++) {
+			PacketBlock* block = packet_block_create(i, 0);
+
+			if (block == NULL)
+				return false;
+
+			block->next = packetPool.free[i];
+			packetPool.free[i] = block;
+		}
+	}
+
+	return true;
+}
+
+inline static void packet_pool_destroy(void) {
+	for (uint32_t i = 0; i < PACKET_POOL_CLASSES; i++) {
+		while (packetPool.free[i] != NULL) {
+			PacketBlock* block = packetPool.free[i];
+
+			packetPool.free[i] = block->next;
+
+			je_free(block);
+		}
+	}
+
+	aws_mutex_clean_up(&packetPool.mutex);
+}
+
+// Returns a writable buffer of at least the given size, blocks beyond the largest class bypass the pool
+inline static uint8_t* packet_allocate(size_t size) {
+	uint32_t sizeClass = packet_pool_class(size);
+	PacketBlock* block = NULL;
+
+	if (sizeClass < PACKET_POOL_CLASSES) {
+		aws_mutex_lock(&packetPool.mutex);
+
+		if ((block = packetPool.free[sizeClass]) != NULL)
+			packetPool.free[sizeClass] = block->next;
+
+		aws_mutex_unlock(&packetPool.mutex);
+	}
+
+	if (block == NULL && (block = packet_block_create(sizeClass, size)) == NULL)
+		abort();
+
+	return (uint8_t*)(block + 1);
+}
+
+// Called from whichever thread destroys the packet, which is the network thread when it's enabled
+inline static void packet_release(uint8_t* data) {
+	PacketBlock* block = PACKET_BLOCK(data);
+
+	if (block->sizeClass == PACKET_POOL_OVERSIZE) {
+		je_free(block);
+
+		return;
+	}
+
+	aws_mutex_lock(&packetPool.mutex);
+
+	block->next = packetPool.free[block->sizeClass];
+	packetPool.free[block->sizeClass] = block;
+
+	aws_mutex_unlock(&packetPool.mutex);
+}
+
+// Returns a pooled buffer of at least the given size, which stays with the caller until it's committed to the queue
+inline static uint8_t* packet_queue_reserve(PacketQueue* queue, size_t size) {
+	if (queue->count == queue->limit) {
+		uint32_t limit = (queue->limit > 0) ? queue->limit * 2 : 64;
+		uint8_t** buffers = (uint8_t**)je_realloc(queue->buffers, sizeof(uint8_t*) * limit);
+
+		if (buffers == NULL)
+			return NULL;
+
+		queue->buffers = buffers;
+
+		uint32_t* lengths = (uint32_t*)je_realloc(queue->lengths, sizeof(uint32_t) * limit);
+
+		if (lengths == NULL)
+			return NULL;
+
+		queue->lengths = lengths;
+		queue->limit = limit;
+	}
+
+	return packet_allocate(size);
+}
+
+inline static void packet_queue_commit(PacketQueue* queue, uint8_t* buffer, size_t length) {
+	queue->buffers[queue->count] = buffer;
+	queue->lengths[queue->count++] = (uint32_t)length;
+}
+
+static void packet_free_callback(void* packet) {
+	packet_release(((ENetPacket*)packet)->data);
+}
+
+inline static ENetPacket* packet_wrap(uint8_t* data, size_t length, bool reliable) {
+	ENetPacket* packet = enet_packet_create(data, length, ENET_PACKET_FLAG_NO_ALLOCATE | (!reliable ? ENET_PACKET_FLAG_NONE : ENET_PACKET_FLAG_RELIABLE));
+
+	packet->freeCallback = packet_free_callback;
+
+	return packet;
+}
+
+// Interest
+
+#ifdef NETDYNAMICS_SERVER
+	typedef struct _InterestGrid {
+		uint32_t* cellStart;
+		uint32_t* cellCursor;
+		uint32_t* cellSlots;
+		uint32_t* slotCell;
+		uint32_t* gather;
+		uint32_t columns;
+		uint32_t rows;
+		uint32_t capacity;
+	} InterestGrid;
+
+	static InterestGrid interestGrid;
+	static Rectangle views[NET_MAX_CLIENTS]; // Zero width until the client reports its view
+
+	inline static bool interest_create(void) {
+		interestGrid.columns = (settings.resolutionWidth + settings.cellSize - 1) / settings.cellSize;
+		interestGrid.rows = (settings.resolutionHeight + settings.cellSize - 1) / settings.cellSize;
+
+		uint32_t cells = interestGrid.columns * interestGrid.rows;
+
+		interestGrid.cellStart = (uint32_t*)je_malloc(sizeof(uint32_t) * (cells + 1));
+		interestGrid.cellCursor = (uint32_t*)je_malloc(sizeof(uint32_t) * cells);
+
+		return interestGrid.cellStart != NULL && interestGrid.cellCursor != NULL;
+	}
+
+	inline static void interest_destroy(void) {
+		je_free(interestGrid.cellStart);
+		je_free(interestGrid.cellCursor);
+		je_free(interestGrid.cellSlots);
+		je_free(interestGrid.slotCell);
+		je_free(interestGrid.gather);
+
+		memset(&interestGrid, 0, sizeof(interestGrid));
+	}
+
+	inline static uint32_t interest_clamp(float value, uint32_t limit) {
+		if (value < 0.0f)
+			return 0;
+
+		uint32_t cell = (uint32_t)value / settings.cellSize;
+
+		return (cell < limit) ? cell : limit - 1;
+	}
+
+	// Rebuilt with a counting sort every send tick, entities outside of the play area fall into the border cells
+	inline static bool interest_update(void) {
+		if (interestGrid.capacity < entities.capacity) {
+			uint32_t* cellSlots = (uint32_t*)je_realloc(interestGrid.cellSlots, sizeof(uint32_t) * entities.capacity);
+
+			if (cellSlots != NULL)
+				interestGrid.cellSlots = cellSlots;
+
+			uint32_t* slotCell = (uint32_t*)je_realloc(interestGrid.slotCell, sizeof(uint32_t) * entities.capacity);
+
+			if (slotCell != NULL)
+				interestGrid.slotCell = slotCell;
+
+			uint32_t* gather = (uint32_t*)je_realloc(interestGrid.gather, sizeof(uint32_t) * entities.capacity);
+
+			if (gather != NULL)
+				interestGrid.gather = gather;
+
+			if (cellSlots == NULL || slotCell == NULL || gather == NULL)
+				return false;
+
+			interestGrid.capacity = entities.capacity;
+		}
+
+		uint32_t cells = interestGrid.columns * interestGrid.rows;
+
+		memset(interestGrid.cellStart, 0, sizeof(uint32_t) * (cells + 1));
+
+		for (uint32_t i = 0; i < entities.count; i++) {
+			uint32_t cell = interest_clamp(components.positionY[i], interestGrid.rows) * interestGrid.columns + interest_clamp(components.positionX[i], interestGrid.columns);
+
+			interestGrid.slotCell[i] = cell;
+			interestGrid.cellStart[cell + 1]++;
+		}
+
+		for (uint32_t i = 0; i < cells; i++) {
+			interestGrid.cellStart[i + 1] += interestGrid.cellStart[i];
+		}
+
+		memcpy(interestGrid.cellCursor, interestGrid.cellStart, sizeof(uint32_t) * cells);
+
+		for (uint32_t i = 0; i < entities.count; i++) {
+			interestGrid.cellSlots[interestGrid.cellCursor[interestGrid.slotCell[i]]++] = i;
+		}
+
+		return true;
+	}
+
+	// Collects the slots of entities whose texture overlaps the view
+	inline static uint32_t interest_gather(const Rectangle* view) {
+		if (view->width <= 0.0f || view->height <= 0.0f) {
+			for (uint32_t i = 0; i < entities.count; i++) {
+				interestGrid.gather[i] = i;
+			}
+
+			return entities.count;
+		}
+
+		float left = view->x - textureWidth, right = view->x + view->width;
+		float top = view->y - textureHeight, bottom = view->y + view->height;
+		uint32_t firstColumn = interest_clamp(left, interestGrid.columns), lastColumn = interest_clamp(right, interestGrid.columns);
+		uint32_t firstRow = interest_clamp(top, interestGrid.rows), lastRow = interest_clamp(bottom, interestGrid.rows);
+		uint32_t count = 0;
+
+		for (uint32_t row = firstRow; row <= lastRow; row++) {
+			uint32_t first = interestGrid.cellStart[row * interestGrid.columns + firstColumn];
+			uint32_t last = interestGrid.cellStart[row * interestGrid.columns + lastColumn + 1];
+
+			for (uint32_t i = first; i < last; i++) {
+				uint32_t slot = interestGrid.cellSlots[i];
+				float x = components.positionX[slot], y = components.positionY[slot];
+
+				// Border cells also hold everything beyond the play area
+				if (x >= left && x <= right && y >= top && y <= bottom)
+					interestGrid.gather[count++] = slot;
+			}
+		}
+
+		return count;
+	}
+#endif
+
+// Serialization
+
+#define PACKED_HEADER_ID 0
+
+#define PACKED_SPAWN_ENTITY 1
+#define PACKED_SPAWN_POSITION_X 5
+#define PACKED_SPAWN_POSITION_Y 9
+#define PACKED_SPAWN_SPEED_X 13
+#define PACKED_SPAWN_SPEED_Y 17
+#define PACKED_SPAWN_COLOR_R 21
+#define PACKED_SPAWN_COLOR_G 22
+#define PACKED_SPAWN_COLOR_B 23
+#define PACKED_SPAWN_SIZE 24
+
+#define PACKED_SPAWN_REQUEST_POSITION_X 1
+#define PACKED_SPAWN_REQUEST_POSITION_Y 5
+#define PACKED_SPAWN_REQUEST_SIZE 9
+
+#define PACKED_MOVE_ENTITY 1
+#define PACKED_MOVE_POSITION_X 5
+#define PACKED_MOVE_POSITION_Y 9
+#define PACKED_MOVE_SPEED_X 13
+#define PACKED_MOVE_SPEED_Y 17
+#define PACKED_MOVE_SIZE 21
+
+#define PACKED_DESTROY_ENTITY 1
+#define PACKED_DESTROY_SIZE 5
+
+#define PACKED_BATCH_COUNT 1
+#define PACKED_BATCH_ENTRIES 3
+#define PACKED_BATCH_ENTRY_ENTITY 0
+#define PACKED_BATCH_ENTRY_POSITION_X 4
+#define PACKED_BATCH_ENTRY_POSITION_Y 8
+#define PACKED_BATCH_ENTRY_SPEED_X 12
+#define PACKED_BATCH_ENTRY_SPEED_Y 16
+#define PACKED_BATCH_ENTRY_SIZE 20
+
+#define PACKED_DELTA_SEQUENCE 1
+#define PACKED_DELTA_BASELINE 5
+#define PACKED_DELTA_TOTAL 9
+#define PACKED_DELTA_FIRST 13
+#define PACKED_DELTA_COUNT 17
+#define PACKED_DELTA_ENTRIES 19
+#define PACKED_DELTA_ENTRY_MAX_SIZE 22 // Flags, two varints, speed and color
+
+#define PACKED_DELTA_FLAG_ABSOLUTE 1
+#define PACKED_DELTA_FLAG_SPEED 2
+#define PACKED_DELTA_FLAG_COLOR 4
+#define PACKED_DELTA_FLAG_EMPTY 8
+
+#define PACKED_ACK_SEQUENCE 1
+#define PACKED_ACK_SIZE 5
+
+#define PACKED_VIEW_X 1
+#define PACKED_VIEW_Y 5
+#define PACKED_VIEW_WIDTH 9
+#define PACKED_VIEW_HEIGHT 13
+#define PACKED_VIEW_SIZE 17
+
+#define PACKED_SPAWN_BATCH_ENTRY_ENTITY 0
+#define PACKED_SPAWN_BATCH_ENTRY_POSITION_X 4
+#define PACKED_SPAWN_BATCH_ENTRY_POSITION_Y 8
+#define PACKED_SPAWN_BATCH_ENTRY_SPEED_X 12
+#define PACKED_SPAWN_BATCH_ENTRY_SPEED_Y 16
+#define PACKED_SPAWN_BATCH_ENTRY_COLOR_R 20
+#define PACKED_SPAWN_BATCH_ENTRY_COLOR_G 21
+#define PACKED_SPAWN_BATCH_ENTRY_COLOR_B 22
+#define PACKED_SPAWN_BATCH_ENTRY_SIZE 23
+
+#define PACKED_DESTROY_RANGE_FIRST 0
+#define PACKED_DESTROY_RANGE_COUNT 4
+#define PACKED_DESTROY_RANGE_SIZE 6
+
+#define PACKED_QUANTIZED_FIRST 1
+#define PACKED_QUANTIZED_COUNT 5
+#define PACKED_QUANTIZED_POSITION_BITS 7
+#define PACKED_QUANTIZED_SPEED_BITS 8
+#define PACKED_QUANTIZED_WIDTH 9
+#define PACKED_QUANTIZED_HEIGHT 11
+#define PACKED_QUANTIZED_ENTRIES 13
+
+// State batches end with the server tick and send time, after the redundant bytes
+#define PACKED_STAMP_TICK 0
+#define PACKED_STAMP_TIME 4
+#define PACKED_STAMP_SIZE 12
+
+typedef struct _BitWriter {
+	uint8_t* buffer;
+	size_t offset;
+	uint64_t scratch;
+	uint32_t bits;
+} BitWriter;
+
+typedef struct _BitReader {
+	const uint8_t* buffer;
+	size_t offset;
+	size_t length;
+	uint64_t scratch;
+	uint32_t bits;
+} BitReader;
+
+inline static void packed_write_uint8(uint8_t* buffer, size_t offset, uint8_t value) {
+	buffer[offset] = value;
+}
+
+inline static void packed_write_uint16(uint8_t* buffer, size_t offset, uint16_t value) {
+	buffer[offset] = (uint8_t)value;
+	buffer[offset + 1] = (uint8_t)(value >> 8);
+}
+
+inline static void packed_write_uint32(uint8_t* buffer, size_t offset, uint32_t value) {
+	buffer[offset] = (uint8_t)value;
+	buffer[offset + 1] = (uint8_t)(value >> 8);
+	buffer[offset + 2] = (uint8_t)(value >> 16);
+	buffer[offset + 3] = (uint8_t)(value >> 24);
+}
+
+inline static void packed_write_uint64(uint8_t* buffer, size_t offset, uint64_t value) {
+	packed_write_uint32(buffer, offset, (uint32_t)value);
+	packed_write_uint32(buffer, offset + 4, (uint32_t)(value >> 32));
+}
+
+inline static void packed_write_float(uint8_t* buffer, size_t offset, float value) {
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	packed_write_uint32(buffer, offset, bits);
+}
+
+inline static uint8_t packed_read_uint8(const uint8_t* buffer, size_t offset) {
+	return buffer[offset];
+}
+
+inline static uint16_t packed_read_uint16(const uint8_t* buffer, size_t offset) {
+	return (uint16_t)(buffer[offset] | (buffer[offset + 1] << 8));
+}
+
+inline static uint32_t packed_read_uint32(const uint8_t* buffer, size_t offset) {
+	return (uint32_t)buffer[offset] | ((uint32_t)buffer[offset + 1] << 8) | ((uint32_t)buffer[offset + 2] << 16) | ((uint32_t)buffer[offset + 3] << 24);
+}
+
+inline static uint64_t packed_read_uint64(const uint8_t* buffer, size_t offset) {
+	return (uint64_t)packed_read_uint32(buffer, offset) | ((uint64_t)packed_read_uint32(buffer, offset + 4) << 32);
+}
+
+inline static float packed_read_float(const uint8_t* buffer, size_t offset) {
+	uint32_t bits = packed_read_uint32(buffer, offset);
+	float value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+inline static size_t packed_write_varint(uint8_t* buffer, size_t offset, int32_t value) {
+	uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+
+	while (zigzag >= 0x80) {
+		buffer[offset++] = (uint8_t)(zigzag | 0x80);
+		zigzag >>= 7;
+	}
+
+	buffer[offset++] = (uint8_t)zigzag;
+
+	return offset;
+}
+
+inline static bool packed_read_varint(const uint8_t* buffer, size_t* offset, size_t length, int32_t* value) {
+	uint32_t zigzag = 0;
+
+	for (uint32_t shift = 0; shift < 35; shift += 7) {
+		if (*offset >= length)
+			return false;
+
+		uint8_t byte = buffer[(*offset)++];
+
+		zigzag |= (uint32_t)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0) {
+			*value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline static void packed_write_bits(BitWriter* writer, uint32_t value, uint32_t bits) {
+	writer->scratch |= (uint64_t)value << writer->bits;
+	writer->bits += bits;
+
+	while (writer->bits >= 8) {
+		writer->buffer[writer->offset++] = (uint8_t)writer->scratch;
+		writer->scratch >>= 8;
+		writer->bits -= 8;
+	}
+}
+
+inline static size_t packed_flush_bits(BitWriter* writer) {
+	if (writer->bits > 0) {
+		writer->buffer[writer->offset++] = (uint8_t)writer->scratch;
+		writer->scratch = 0;
+		writer->bits = 0;
+	}
+
+	return writer->offset;
+}
+
+inline static bool packed_read_bits(BitReader* reader, uint32_t bits, uint32_t* value) {
+	while (reader->bits < bits) {
+		if (reader->offset >= reader->length)
+			return false;
+
+		reader->scratch |= (uint64_t)reader->buffer[reader->offset++] << reader->bits;
+		reader->bits += 8;
+	}
+
+	*value = (uint32_t)(reader->scratch & ((1ull << bits) - 1));
+	reader->scratch >>= bits;
+	reader->bits -= bits;
+
+	return true;
+}
+
+inline static uint32_t quantize(float value, float minimum, float maximum, uint32_t bits) {
+	uint32_t steps = (1u << bits) - 1;
+	float normalized = (value - minimum) / (maximum - minimum);
+
+	if (normalized < 0.0f)
+		normalized = 0.0f;
+	else if (normalized > 1.0f)
+		normalized = 1.0f;
+
+	return (uint32_t)(normalized * steps + 0.5f);
+}
+
+inline static float dequantize(uint32_t value, float minimum, float maximum, uint32_t bits) {
+	uint32_t steps = (1u << bits) - 1;
+
+	return minimum + (maximum - minimum) * ((float)value / steps);
+}
+
+inline static size_t packed_write_redundancy(uint8_t* buffer, size_t length) {
+	if (settings.redundantBytes > 0)
+		memcpy(buffer + length, redundancyBuffer, settings.redundantBytes);
+
+	return length + settings.redundantBytes;
+}
+
+#ifdef NETDYNAMICS_SERVER
+	static uint32_t stampTick;
+	static uint64_t stampTime;
+
+	// All batches of a send interval carry the same stamp, the encoders may run on the workers
+	inline static void packed_stamp_update(void) {
+		stampTick++;
+
+		aws_high_res_clock_get_ticks(&stampTime);
+	}
+
+	inline static size_t packed_write_stamp(uint8_t* buffer, size_t length) {
+		packed_write_uint32(buffer, length + PACKED_STAMP_TICK, stampTick);
+		packed_write_uint64(buffer, length + PACKED_STAMP_TIME, stampTime);
+
+		return length + PACKED_STAMP_SIZE;
+	}
+#endif
+
+// Submitting takes ownership of a buffer from packet_allocate, the transport sends it in place and returns it to the pool
+
+#ifdef NETDYNAMICS_SERVER
+	inline static void packet_submit_to_all(uint8_t* data, size_t length, uint8_t channel) {
+		metrics_sent(length, connected);
+		channel_sent(channel, length, connected);
+		capture_record(CAPTURE_EVENT_SEND, CAPTURE_BROADCAST, channelReliable[channel], data, length);
+
+		transport->broadcast(data, length, settings.channels[channel], channelReliable[channel]);
+	}
+
+	inline static void packet_send_to_all(const void* data, size_t length, uint8_t channel) {
+		uint8_t* buffer = packet_allocate(length);
+
+		memcpy(buffer, data, length);
+
+		packet_submit_to_all(buffer, length, channel);
+	}
+#endif
+
+inline static void packet_submit(void* client, uint8_t* data, size_t length, uint8_t channel) {
+	metrics_sent(length, 1);
+	channel_sent(channel, length, 1);
+	capture_record(CAPTURE_EVENT_SEND, (client != NULL) ? transport->identify(client) : 0, channelReliable[channel], data, length);
+
+	transport->send(client, data, length, settings.channels[channel], channelReliable[channel]);
+}
+
+inline static void packet_send(void* client, const void* data, size_t length, uint8_t channel) {
+	uint8_t* buffer = packet_allocate(length);
+
+	memcpy(buffer, data, length);
+
+	packet_submit(client, buffer, length, channel);
+}
+
+#ifdef NETDYNAMICS_SERVER
+	inline static size_t message_pack(uint8_t* buffer, uint8_t id, const Entity* entityLocal, uint8_t* channel) {
+		uint32_t slot = entity_slot(*entityLocal);
+
+		if (slot == ENTITY_NONE && id != NET_MESSAGE_DESTROY)
+			return 0;
+
+		packed_write_uint8(buffer, PACKED_HEADER_ID, id);
+
+		if (id == NET_MESSAGE_SPAWN) {
+			*channel = NET_CHANNEL_CONTROL;
+
+			packed_write_uint32(buffer, PACKED_SPAWN_ENTITY, *entityLocal);
+			packed_write_float(buffer, PACKED_SPAWN_POSITION_X, components.positionX[slot]);
+			packed_write_float(buffer, PACKED_SPAWN_POSITION_Y, components.positionY[slot]);
+			packed_write_float(buffer, PACKED_SPAWN_SPEED_X, components.speedX[slot]);
+			packed_write_float(buffer, PACKED_SPAWN_SPEED_Y, components.speedY[slot]);
+			packed_write_uint8(buffer, PACKED_SPAWN_COLOR_R, components.color[slot].r);
+			packed_write_uint8(buffer, PACKED_SPAWN_COLOR_G, components.color[slot].g);
+			packed_write_uint8(buffer, PACKED_SPAWN_COLOR_B, components.color[slot].b);
+
+			return PACKED_SPAWN_SIZE;
+		} else if (id == NET_MESSAGE_MOVE) {
+			*channel = NET_CHANNEL_STATE;
+
+			packed_write_uint32(buffer, PACKED_MOVE_ENTITY, *entityLocal);
+			packed_write_float(buffer, PACKED_MOVE_POSITION_X, components.positionX[slot]);
+			packed_write_float(buffer, PACKED_MOVE_POSITION_Y, components.positionY[slot]);
+			packed_write_float(buffer, PACKED_MOVE_SPEED_X, components.speedX[slot]);
+			packed_write_float(buffer, PACKED_MOVE_SPEED_Y, components.speedY[slot]);
+
+			return PACKED_MOVE_SIZE;
+		} else if (id == NET_MESSAGE_DESTROY) {
+			*channel = NET_CHANNEL_CONTROL;
+
+			packed_write_uint32(buffer, PACKED_DESTROY_ENTITY, *entityLocal);
+
+			return PACKED_DESTROY_SIZE;
+		}
+
+		return 0;
+	}
+
+	inline static void message_pack_spawn_entry(uint8_t* entry, uint32_t slot) {
+		packed_write_uint32(entry, PACKED_SPAWN_BATCH_ENTRY_ENTITY, entities.dense[slot]);
+		packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_X, components.positionX[slot]);
+		packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_Y, components.positionY[slot]);
+		packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_X, components.speedX[slot]);
+		packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_Y, components.speedY[slot]);
+		packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_R, components.color[slot].r);
+		packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_G, components.color[slot].g);
+		packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_B, components.color[slot].b);
+	}
+
+	inline static void message_add_spawn_entry(binn* data, uint32_t slot) {
+		binn_list_add_uint32(data, entities.dense[slot]);
+		binn_list_add_float(data, components.positionX[slot]);
+		binn_list_add_float(data, components.positionY[slot]);
+		binn_list_add_float(data, components.speedX[slot]);
+		binn_list_add_float(data, components.speedY[slot]);
+		binn_list_add_uint8(data, components.color[slot].r);
+		binn_list_add_uint8(data, components.color[slot].g);
+		binn_list_add_uint8(data, components.color[slot].b);
+	}
+
+	inline static void message_send_to_all(uint8_t id, const Entity* entityLocal) {
+		uint8_t channel = NET_CHANNEL_STATE;
+
+		if (settings.serializer == NET_SERIALIZER_PACKED) {
+			uint8_t* buffer = packet_allocate(PACKED_SPAWN_SIZE + settings.redundantBytes);
+			size_t length = message_pack(buffer, id, entityLocal, &channel);
+
+			if (length > 0)
+				packet_submit_to_all(buffer, packed_write_redundancy(buffer, length), channel);
+			else
+				packet_release(buffer);
+
+			return;
+		}
+
+		uint32_t slot = entity_slot(*entityLocal);
+
+		if (slot == ENTITY_NONE && id != NET_MESSAGE_DESTROY)
+			return;
+
+		binn* data = binn_list();
+
+		binn_list_add_uint8(data, id);
+
+		if (id == NET_MESSAGE_SPAWN) {
+			channel = NET_CHANNEL_CONTROL;
+
+			binn_list_add_uint32(data, *entityLocal);
+			binn_list_add_float(data, components.positionX[slot]);
+			binn_list_add_float(data, components.positionY[slot]);
+			binn_list_add_float(data, components.speedX[slot]);
+			binn_list_add_float(data, components.speedY[slot]);
+			binn_list_add_uint8(data, components.color[slot].r);
+			binn_list_add_uint8(data, components.color[slot].g);
+			binn_list_add_uint8(data, components.color[slot].b);
+		} else if (id == NET_MESSAGE_MOVE) {
+			channel = NET_CHANNEL_STATE;
+
+			binn_list_add_uint32(data, *entityLocal);
+			binn_list_add_float(data, components.positionX[slot]);
+			binn_list_add_float(data, components.positionY[slot]);
+			binn_list_add_float(data, components.speedX[slot]);
+			binn_list_add_float(data, components.speedY[slot]);
+		} else if (id == NET_MESSAGE_DESTROY) {
+			channel = NET_CHANNEL_CONTROL;
+
+			binn_list_add_uint32(data, *entityLocal);
+		} else {
+			goto escape;
+		}
+
+		if (settings.redundantBytes > 0)
+			binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+		packet_send_to_all(binn_ptr(data), binn_size(data), channel);
+
+		escape:
+
+		binn_free(data);
+	}
+
+	inline static void message_commit_binn(PacketQueue* packets, binn* data) {
+		uint8_t* buffer = packet_queue_reserve(packets, binn_size(data) + PACKED_STAMP_SIZE);
+
+		if (buffer != NULL) {
+			memcpy(buffer, binn_ptr(data), binn_size(data));
+			packet_queue_commit(packets, buffer, packed_write_stamp(buffer, binn_size(data)));
+		}
+
+		binn_free(data);
+	}
+
+	inline static void message_submit_binn(void* client, binn* data) {
+		uint8_t* buffer = packet_allocate(binn_size(data) + PACKED_STAMP_SIZE);
+
+		memcpy(buffer, binn_ptr(data), binn_size(data));
+		packet_submit(client, buffer, packed_write_stamp(buffer, binn_size(data)), NET_CHANNEL_STATE);
+		binn_free(data);
+	}
+
+	// Streams below cover a range of entity indices, so the client addresses them without handles
+	static void message_encode_batch(Job* job) {
+		#define MOVE_ENTRY_SIZE 25 // Worst case of an entity and four floats with a byte of type per item
+
+		PacketQueue* packets = &job->packets;
+		uint32_t first = job->first, last = job->last;
+		size_t packetSize = ((settings.maxPayload > PACKED_SPAWN_SIZE) ? settings.maxPayload : PACKED_SPAWN_SIZE) + PACKED_BATCH_ENTRY_SIZE + settings.redundantBytes + PACKED_STAMP_SIZE;
+		uint32_t batchSize = (settings.batchSize > 0) ? settings.batchSize : UINT16_MAX; // Without a batch size only the payload cuts packets, as in message_batch_capacity
+
+		if (settings.serializer == NET_SERIALIZER_PACKED && settings.positionBits > 0) {
+			uint32_t entryBits = (settings.positionBits + settings.speedBits) * 2 + 1;
+			uint32_t capacity = 1;
+
+			if (settings.maxPayload > PACKED_QUANTIZED_ENTRIES + settings.redundantBytes)
+				capacity = ((settings.maxPayload - PACKED_QUANTIZED_ENTRIES - settings.redundantBytes) * 8) / entryBits;
+
+			if (capacity > batchSize)
+				capacity = batchSize;
+
+			if (capacity == 0)
+				capacity = 1;
+
+			float minimumX = -textureWidth, maximumX = settings.resolutionWidth + textureWidth;
+			float minimumY = -textureHeight, maximumY = settings.resolutionHeight + textureHeight;
+
+			for (uint32_t i = first; i < last; i += capacity) {
+				uint32_t entries = (last - i < capacity) ? last - i : capacity;
+				uint8_t* buffer = packet_queue_reserve(packets, packetSize);
+
+				if (buffer == NULL)
+					return;
+
+				BitWriter writer = { buffer, PACKED_QUANTIZED_ENTRIES };
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_QUANTIZED);
+				packed_write_uint32(buffer, PACKED_QUANTIZED_FIRST, i);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_COUNT, (uint16_t)entries);
+				packed_write_uint8(buffer, PACKED_QUANTIZED_POSITION_BITS, settings.positionBits);
+				packed_write_uint8(buffer, PACKED_QUANTIZED_SPEED_BITS, settings.speedBits);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_WIDTH, settings.resolutionWidth);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_HEIGHT, settings.resolutionHeight);
+
+				for (uint32_t j = i; j < i + entries; j++) {
+					uint32_t slot = entity_lookup(j);
+
+					packed_write_bits(&writer, slot != ENTITY_NONE, 1);
+
+					if (slot == ENTITY_NONE)
+						continue;
+
+					packed_write_bits(&writer, quantize(components.positionX[slot], minimumX, maximumX, settings.positionBits), settings.positionBits);
+					packed_write_bits(&writer, quantize(components.positionY[slot], minimumY, maximumY, settings.positionBits), settings.positionBits);
+					packed_write_bits(&writer, quantize(components.speedX[slot], -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, settings.speedBits), settings.speedBits);
+					packed_write_bits(&writer, quantize(components.speedY[slot], -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, settings.speedBits), settings.speedBits);
+				}
+
+				packet_queue_commit(packets, buffer, packed_write_stamp(buffer, packed_write_redundancy(buffer, packed_flush_bits(&writer))));
+			}
+
+			return;
+		}
+
+		if (settings.serializer == NET_SERIALIZER_PACKED) {
+			uint32_t capacity = 1;
+
+			if (settings.maxPayload > PACKED_BATCH_ENTRIES + PACKED_BATCH_ENTRY_SIZE + settings.redundantBytes)
+				capacity = (settings.maxPayload - PACKED_BATCH_ENTRIES - settings.redundantBytes) / PACKED_BATCH_ENTRY_SIZE;
+
+			if (capacity > batchSize)
+				capacity = batchSize;
+
+			for (uint32_t i = first; i < last;) {
+				uint32_t entries = 0;
+				uint8_t* buffer = packet_queue_reserve(packets, packetSize);
+
+				if (buffer == NULL)
+					return;
+
+				uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+				for (; i < last && entries < capacity; i++) {
+					uint32_t slot = entity_lookup(i);
+
+					if (slot == ENTITY_NONE)
+						continue;
+
+					packed_write_uint32(entry, PACKED_BATCH_ENTRY_ENTITY, entities.dense[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_X, components.positionX[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_Y, components.positionY[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_X, components.speedX[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_Y, components.speedY[slot]);
+
+					entries++;
+					entry += PACKED_BATCH_ENTRY_SIZE;
+				}
+
+				if (entries == 0) {
+					packet_release(buffer);
+
+					break;
+				}
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_BATCH);
+				packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+
+				packet_queue_commit(packets, buffer, packed_write_stamp(buffer, packed_write_redundancy(buffer, entry - buffer)));
+			}
+
+			return;
+		}
+
+		binn* data = NULL;
+		uint32_t entries = 0;
+
+		for (uint32_t i = first; i < last; i++) {
+			uint32_t slot = entity_lookup(i);
+
+			if (slot == ENTITY_NONE)
+				continue;
+
+			if (data == NULL) {
+				data = binn_list();
+				entries = 0;
+
+				binn_list_add_uint8(data, NET_MESSAGE_MOVE_BATCH);
+			}
+
+			binn_list_add_uint32(data, entities.dense[slot]);
+			binn_list_add_float(data, components.positionX[slot]);
+			binn_list_add_float(data, components.positionY[slot]);
+			binn_list_add_float(data, components.speedX[slot]);
+			binn_list_add_float(data, components.speedY[slot]);
+
+			entries++;
+
+			if (entries == batchSize || binn_size(data) + MOVE_ENTRY_SIZE + settings.redundantBytes > settings.maxPayload) {
+				if (settings.redundantBytes > 0)
+					binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+				message_commit_binn(packets, data);
+
+				data = NULL;
+			}
+		}
+
+		if (data != NULL) {
+			if (settings.redundantBytes > 0)
+				binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+			message_commit_binn(packets, data);
+		}
+	}
+
+	inline static void message_send_batch_to_all(uint32_t first, uint32_t last) {
+		uint32_t jobs = job_pool_run(message_encode_batch, first, last);
+
+		// Chunks are sent in order, so the stream looks the same as if it was serialized on a single thread
+		for (uint32_t i = 0; i < jobs; i++) {
+			const PacketQueue* packets = &jobPool.jobs[i].packets;
+
+			for (uint32_t j = 0; j < packets->count; j++) {
+				packet_submit_to_all(packets->buffers[j], packets->lengths[j], NET_CHANNEL_STATE);
+			}
+		}
+	}
+
+	// Entries per packet for per-client batches, binn packets are additionally cut when they reach the payload size
+	inline static uint32_t message_batch_capacity(void) {
+		uint32_t capacity = (settings.batchSize > 0) ? settings.batchSize : UINT16_MAX;
+
+		if (settings.serializer == NET_SERIALIZER_PACKED) {
+			uint32_t limit = 1;
+
+			if (settings.maxPayload > PACKED_BATCH_ENTRIES + PACKED_BATCH_ENTRY_SIZE + settings.redundantBytes)
+				limit = (settings.maxPayload - PACKED_BATCH_ENTRIES - settings.redundantBytes) / PACKED_BATCH_ENTRY_SIZE;
+
+			if (capacity > limit)
+				capacity = limit;
+		}
+
+		return capacity;
+	}
+
+	inline static void message_send_batch(void* client, const uint32_t* slots, uint32_t count) {
+		uint32_t capacity = message_batch_capacity();
+
+		if (settings.serializer == NET_SERIALIZER_PACKED) {
+			for (uint32_t i = 0; i < count; i += capacity) {
+				uint32_t entries = (count - i < capacity) ? count - i : capacity;
+				uint8_t* buffer = packet_allocate(PACKED_BATCH_ENTRIES + entries * PACKED_BATCH_ENTRY_SIZE + settings.redundantBytes + PACKED_STAMP_SIZE);
+				uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_BATCH);
+				packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+
+				for (uint32_t j = i; j < i + entries; j++, entry += PACKED_BATCH_ENTRY_SIZE) {
+					uint32_t slot = slots[j];
+
+					packed_write_uint32(entry, PACKED_BATCH_ENTRY_ENTITY, entities.dense[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_X, components.positionX[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_Y, components.positionY[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_X, components.speedX[slot]);
+					packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_Y, components.speedY[slot]);
+				}
+
+				packet_submit(client, buffer, packed_write_stamp(buffer, packed_write_redundancy(buffer, entry - buffer)), NET_CHANNEL_STATE);
+			}
+
+			return;
+		}
+
+		binn* data = NULL;
+		uint32_t entries = 0;
+
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t slot = slots[i];
+
+			if (data == NULL) {
+				data = binn_list();
+				entries = 0;
+
+				binn_list_add_uint8(data, NET_MESSAGE_MOVE_BATCH);
+			}
+
+			binn_list_add_uint32(data, entities.dense[slot]);
+			binn_list_add_float(data, components.positionX[slot]);
+			binn_list_add_float(data, components.positionY[slot]);
+			binn_list_add_float(data, components.speedX[slot]);
+			binn_list_add_float(data, components.speedY[slot]);
+
+			entries++;
+
+			if (i == count - 1 || entries == capacity || binn_size(data) + MOVE_ENTRY_SIZE + settings.redundantBytes > settings.maxPayload) {
+				if (settings.redundantBytes > 0)
+					binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+				message_submit_binn(client, data);
+
+				data = NULL;
+			}
+		}
+	}
+
+	inline static void snapshot_capture(void) {
+		int32_t* current = SNAPSHOT_SLOT(snapshot);
+
+		for (uint32_t i = 0; i < entities.count; i++) {
+			uint32_t index = ENTITY_INDEX(entities.dense[i]);
+
+			current[index * 2] = (int32_t)lroundf(components.positionX[i] * NET_SNAPSHOT_PRECISION);
+			current[index * 2 + 1] = (int32_t)lroundf(components.positionY[i] * NET_SNAPSHOT_PRECISION);
+		}
+	}
+
+	inline static void message_send_delta(void* client, uint32_t baseline) {
+		const int32_t* current = SNAPSHOT_SLOT(snapshot);
+		const int32_t* previous = NULL;
+
+		if (baseline != 0 && snapshot - baseline < NET_SNAPSHOT_HISTORY)
+			previous = SNAPSHOT_SLOT(baseline);
+		else
+			baseline = 0;
+
+		for (uint32_t i = 0; i < entities.indices;) {
+			uint8_t* buffer = packet_allocate(settings.maxPayload + PACKED_DELTA_ENTRIES + PACKED_DELTA_ENTRY_MAX_SIZE + settings.redundantBytes + PACKED_STAMP_SIZE);
+			size_t offset = PACKED_DELTA_ENTRIES;
+			uint32_t first = i;
+
+			packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_DELTA);
+			packed_write_uint32(buffer, PACKED_DELTA_SEQUENCE, snapshot);
+			packed_write_uint32(buffer, PACKED_DELTA_BASELINE, baseline);
+			packed_write_uint32(buffer, PACKED_DELTA_TOTAL, entities.indices);
+			packed_write_uint32(buffer, PACKED_DELTA_FIRST, first);
+
+			do {
+				uint32_t slot = entity_lookup(i);
+
+				if (slot == ENTITY_NONE) {
+					packed_write_uint8(buffer, offset++, PACKED_DELTA_FLAG_EMPTY);
+
+					continue;
+				}
+
+				uint8_t flags = 0;
+				size_t flagsOffset = offset++;
+
+				// Entities spawned after the baseline have no reference position on the client
+				if (previous == NULL || components.colorChanged[slot] > baseline) {
+					flags |= PACKED_DELTA_FLAG_ABSOLUTE;
+
+					offset = packed_write_varint(buffer, offset, current[i * 2]);
+					offset = packed_write_varint(buffer, offset, current[i * 2 + 1]);
+				} else {
+					offset = packed_write_varint(buffer, offset, current[i * 2] - previous[i * 2]);
+					offset = packed_write_varint(buffer, offset, current[i * 2 + 1] - previous[i * 2 + 1]);
+				}
+
+				if (previous == NULL || components.speedChanged[slot] > baseline) {
+					flags |= PACKED_DELTA_FLAG_SPEED;
+
+					packed_write_float(buffer, offset, components.speedX[slot]);
+					packed_write_float(buffer, offset + 4, components.speedY[slot]);
+
+					offset += 8;
+				}
+
+				if (previous == NULL || components.colorChanged[slot] > baseline) {
+					flags |= PACKED_DELTA_FLAG_COLOR;
+
+					packed_write_uint8(buffer, offset, components.color[slot].r);
+					packed_write_uint8(buffer, offset + 1, components.color[slot].g);
+					packed_write_uint8(buffer, offset + 2, components.color[slot].b);
+
+					offset += 3;
+				}
+
+				packed_write_uint8(buffer, flagsOffset, flags);
+			} while (++i < entities.indices && i - first < (settings.batchSize > 0 ? settings.batchSize : UINT16_MAX) && offset + PACKED_DELTA_ENTRY_MAX_SIZE + settings.redundantBytes <= settings.maxPayload);
+
+			packed_write_uint16(buffer, PACKED_DELTA_COUNT, (uint16_t)(i - first));
+			packet_submit(client, buffer, packed_write_stamp(buffer, packed_write_redundancy(buffer, offset)), NET_CHANNEL_STATE);
+		}
+	}
+#endif
+
+inline static void message_send(void* client, uint8_t id, const Entity* entityLocal) {
+	uint8_t channel = NET_CHANNEL_STATE;
+
+	if (settings.serializer == NET_SERIALIZER_PACKED) {
+		uint8_t* buffer = packet_allocate(PACKED_SPAWN_SIZE + settings.redundantBytes);
+		size_t length = 0;
+
+		#ifdef NETDYNAMICS_SERVER
+			length = message_pack(buffer, id, entityLocal, &channel);
+		#elif NETDYNAMICS_CLIENT
+			if (id == NET_MESSAGE_SPAWN) {
+				Vector2 mousePosition = RayGetMousePosition();
+
+				channel = NET_CHANNEL_CONTROL;
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, id);
+				packed_write_float(buffer, PACKED_SPAWN_REQUEST_POSITION_X, mousePosition.x);
+				packed_write_float(buffer, PACKED_SPAWN_REQUEST_POSITION_Y, mousePosition.y);
+
+				length = PACKED_SPAWN_REQUEST_SIZE;
+			} else if (id == NET_MESSAGE_VIEW) {
+				channel = NET_CHANNEL_CONTROL;
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, id);
+				packed_write_float(buffer, PACKED_VIEW_X, settings.viewX);
+				packed_write_float(buffer, PACKED_VIEW_Y, settings.viewY);
+				packed_write_float(buffer, PACKED_VIEW_WIDTH, settings.viewWidth);
+				packed_write_float(buffer, PACKED_VIEW_HEIGHT, settings.viewHeight);
+
+				length = PACKED_VIEW_SIZE;
+			}
+		#endif
+
+		if (length > 0)
+			packet_submit(client, buffer, packed_write_redundancy(buffer, length), channel);
+		else
+			packet_release(buffer);
+
+		return;
+	}
+
+	binn* data = binn_list();
+
+	binn_list_add_uint8(data, id);
+
+	if (id == NET_MESSAGE_SPAWN) {
+		channel = NET_CHANNEL_CONTROL;
+
+		#ifdef NETDYNAMICS_SERVER
+			uint32_t slot = entity_slot(*entityLocal);
+
+			if (slot == ENTITY_NONE)
+				goto escape;
+
+			binn_list_add_uint32(data, *entityLocal);
+			binn_list_add_float(data, components.positionX[slot]);
+			binn_list_add_float(data, components.positionY[slot]);
+			binn_list_add_float(data, components.speedX[slot]);
+			binn_list_add_float(data, components.speedY[slot]);
+			binn_list_add_uint8(data, components.color[slot].r);
+			binn_list_add_uint8(data, components.color[slot].g);
+			binn_list_add_uint8(data, components.color[slot].b);
+		#elif NETDYNAMICS_CLIENT
+			Vector2 mousePosition = RayGetMousePosition();
+
+			binn_list_add_float(data, mousePosition.x);
+			binn_list_add_float(data, mousePosition.y);
+		#endif
+	} else if (id == NET_MESSAGE_VIEW) {
+		channel = NET_CHANNEL_CONTROL;
+
+		binn_list_add_float(data, settings.viewX);
+		binn_list_add_float(data, settings.viewY);
+		binn_list_add_float(data, settings.viewWidth);
+		binn_list_add_float(data, settings.viewHeight);
+	} else {
+		goto escape;
+	}
+
+	if (settings.redundantBytes > 0)
+		binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+	packet_send(client, binn_ptr(data), binn_size(data), channel);
+
+	escape:
+
+	binn_free(data);
+}
+
+#ifdef NETDYNAMICS_CLIENT
+	inline static void lag_update(void) {
+		uint64_t currentLag = 0;
+
+		if (aws_high_res_clock_get_ticks(&currentLag) == AWS_OP_SUCCESS) {
+			if (lastLag > 0) {
+				float lag = ((currentLag - lastLag) / 1000000.0f) / 1000.0f;
+
+				if (lag > worstLag)
+					worstLag = lag;
+			}
+
+			lastLag = currentLag;
+		}
+	}
+
+	inline static uint32_t binn_next_uint32(binn_iter* iter) {
+		binn_value value;
+		int result = 0;
+
+		if (binn_list_next(iter, &value))
+			binn_get_int32(&value, &result);
+
+		return (uint32_t)result;
+	}
+
+	inline static uint8_t binn_next_uint8(binn_iter* iter) {
+		return (uint8_t)binn_next_uint32(iter);
+	}
+
+	inline static float binn_next_float(binn_iter* iter) {
+		binn_value value;
+
+		if (binn_list_next(iter, &value))
+			return value.vfloat;
+
+		return 0.0f;
+	}
+
+	// Latency
+
+	#define LATENCY_DELAY 0
+	#define LATENCY_JITTER 1
+	#define LATENCY_AGE 2
+	#define LATENCY_SERIES 3
+	#define LATENCY_BUCKETS 250
+	#define LATENCY_BUCKET_WIDTH 2.0f
+
+	typedef struct _LatencyStats {
+		float median;
+		float percentile;
+		float maximum;
+	} LatencyStats;
+
+	// Histograms of milliseconds, the last bucket also holds everything beyond the range
+	typedef struct _Latency {
+		uint32_t histograms[LATENCY_SERIES][LATENCY_BUCKETS];
+		float maximum[LATENCY_SERIES];
+		LatencyStats stats[LATENCY_SERIES];
+		uint32_t rtt; // Refreshed once per frame from the transport
+		uint32_t lastTick;
+		uint64_t lastSend;
+		uint64_t lastArrival;
+		uint32_t reorders;
+		uint32_t skipped;
+		float time;
+	} Latency;
+
+	static Latency latency;
+
+	static const char* latencySeries[LATENCY_SERIES] = { "DELAY", "JITTER", "AGE" };
+
+	inline static void latency_record(uint32_t series, float milliseconds) {
+		uint32_t bucket = (milliseconds > 0.0f) ? (uint32_t)(milliseconds / LATENCY_BUCKET_WIDTH) : 0;
+
+		latency.histograms[series][(bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS - 1]++;
+
+		if (latency.maximum[series] < milliseconds)
+			latency.maximum[series] = milliseconds;
+	}
+
+	// The clock offset includes half of the round trip, which is added back to the delays
+	inline static void latency_stamp(uint32_t tick, uint64_t sendTime, uint64_t arrivalTime, uint32_t rtt) {
+		int64_t difference = (int64_t)(arrivalTime - sendTime);
+
+		latency_record(LATENCY_DELAY, (difference - clockOffset) / 1000000.0f + rtt * 0.5f);
+
+		if (latency.lastTick != 0 && tick < latency.lastTick) {
+			latency.reorders++;
+
+			return;
+		}
+
+		if (tick == latency.lastTick)
+			return;
+
+		if (latency.lastTick != 0) {
+			float variation = ((int64_t)(arrivalTime - latency.lastArrival) - (int64_t)(sendTime - latency.lastSend)) / 1000000.0f;
+
+			latency_record(LATENCY_JITTER, (variation < 0.0f) ? -variation : variation);
+
+			latency.skipped += tick - latency.lastTick - 1;
+		}
+
+		latency.lastTick = tick;
+		latency.lastSend = sendTime;
+		latency.lastArrival = arrivalTime;
+	}
+
+	// Strips the stamp of a state batch and returns the length of the message itself
+	inline static size_t latency_receive(const uint8_t* packet, size_t length) {
+		if (length < PACKED_STAMP_SIZE)
+			return length;
+
+		length -= PACKED_STAMP_SIZE;
+		stateTime = packed_read_uint64(packet, length + PACKED_STAMP_TIME);
+
+		if (stateTime == 0)
+			return length;
+
+		uint64_t arrivalTime = 0;
+
+		aws_high_res_clock_get_ticks(&arrivalTime);
+
+		int64_t difference = (int64_t)(arrivalTime - stateTime);
+
+		if (!clockSynchronized || difference < clockOffset) {
+			clockOffset = difference;
+			clockSynchronized = true;
+		}
+
+		// The state is sampled where it would have arrived without any queuing, so arrival jitter stays out of interpolation
+		stateClock = interpolationClock - (difference - clockOffset) / 1000000000.0;
+
+		// Load clients share the process, only the primary connection is measured
+		if (settings.latency > 0 && loadCurrent == 0)
+			latency_stamp(packed_read_uint32(packet, length + PACKED_STAMP_TICK), stateTime, arrivalTime, latency.rtt);
+
+		return length;
+	}
+
+	inline static void latency_reset(void) {
+		memset(&latency, 0, sizeof(latency));
+
+		clockOffset = 0;
+		clockSynchronized = false;
+	}
+
+	inline static LatencyStats latency_summarize(uint32_t series) {
+		LatencyStats stats = { 0 };
+		uint32_t* histogram = latency.histograms[series];
+		uint32_t total = 0, count = 0;
+
+		for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+			total += histogram[i];
+		}
+
+		if (total == 0)
+			return stats;
+
+		uint32_t median = (total + 1) / 2, percentile = (total * 99 + 99) / 100;
+
+		for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+			count += histogram[i];
+
+			if (stats.median == 0.0f && count >= median)
+				stats.median = (i + 1) * LATENCY_BUCKET_WIDTH;
+
+			if (count >= percentile) {
+				stats.percentile = (i + 1) * LATENCY_BUCKET_WIDTH;
+
+				break;
+			}
+		}
+
+		stats.maximum = latency.maximum[series];
+
+		return stats;
+	}
+
+	// Percentiles are upper bounds of the buckets over the last second, the age of every entity is sampled once per second
+	inline static bool latency_update(float deltaTime) {
+		if (settings.latency == 0 || (latency.time += deltaTime) < 1.0f)
+			return false;
+
+		latency.time = 0.0f;
+
+		if (clockSynchronized && components.stateTime != NULL) {
+			uint64_t currentTime = 0;
+
+			aws_high_res_clock_get_ticks(&currentTime);
+
+			for (uint32_t i = 0; i < entities.count; i++) {
+				if (components.stateTime[i] != 0)
+					latency_record(LATENCY_AGE, ((int64_t)(currentTime - components.stateTime[i]) - clockOffset) / 1000000.0f + latency.rtt * 0.5f);
+			}
+		}
+
+		for (uint32_t i = 0; i < LATENCY_SERIES; i++) {
+			latency.stats[i] = latency_summarize(i);
+			latency.maximum[i] = 0.0f;
+
+			memset(latency.histograms[i], 0, sizeof(latency.histograms[i]));
+		}
+
+		return true;
+	}
+
+	inline static void latency_print(void) {
+		FILE* stream = report_stream();
+
+		for (uint32_t i = 0; i < LATENCY_SERIES; i++) {
+			fprintf(stream, "%s%s %.1f/%.1f/%.1f ms", (i > 0) ? " | " : "LATENCY ", latencySeries[i], latency.stats[i].median, latency.stats[i].percentile, latency.stats[i].maximum);
+		}
+
+		fprintf(stream, " | REORDERS %u | SKIPPED %u\n", latency.reorders, latency.skipped);
+		fflush(stream);
+	}
+#endif
+
+inline static uint8_t message_unpack(void* client, const uint8_t* packet, size_t length) {
+	uint8_t id = packed_read_uint8(packet, PACKED_HEADER_ID);
+
+	if (id == NET_MESSAGE_SPAWN) {
+		#ifdef NETDYNAMICS_SERVER
+			if (length >= PACKED_SPAWN_REQUEST_SIZE)
+				entity_spawn((Vector2){ packed_read_float(packet, PACKED_SPAWN_REQUEST_POSITION_X), packed_read_float(packet, PACKED_SPAWN_REQUEST_POSITION_Y) }, NET_MAX_ENTITY_SPAWN);
+		#elif NETDYNAMICS_CLIENT
+			if (length >= PACKED_SPAWN_SIZE)
+				entity_spawn((Entity)packed_read_uint32(packet, PACKED_SPAWN_ENTITY), (Vector2){ packed_read_float(packet, PACKED_SPAWN_POSITION_X), packed_read_float(packet, PACKED_SPAWN_POSITION_Y) }, (Vector2){ packed_read_float(packet, PACKED_SPAWN_SPEED_X), packed_read_float(packet, PACKED_SPAWN_SPEED_Y) }, (Color){ packed_read_uint8(packet, PACKED_SPAWN_COLOR_R), packed_read_uint8(packet, PACKED_SPAWN_COLOR_G), packed_read_uint8(packet, PACKED_SPAWN_COLOR_B), 255 });
+		#endif
+	} else if (id == NET_MESSAGE_MOVE) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+
+			if (length >= PACKED_MOVE_SIZE)
+				entity_update(entity_slot((Entity)packed_read_uint32(packet, PACKED_MOVE_ENTITY)), (Vector2){ packed_read_float(packet, PACKED_MOVE_POSITION_X), packed_read_float(packet, PACKED_MOVE_POSITION_Y) }, (Vector2){ packed_read_float(packet, PACKED_MOVE_SPEED_X), packed_read_float(packet, PACKED_MOVE_SPEED_Y) });
+		#endif
+	} else if (id == NET_MESSAGE_MOVE_BATCH) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+
+			length = latency_receive(packet, length);
+
+			if (length < PACKED_BATCH_ENTRIES)
+				return id;
+
+			uint32_t entries = packed_read_uint16(packet, PACKED_BATCH_COUNT);
+
+			if (entries > (length - PACKED_BATCH_ENTRIES) / PACKED_BATCH_ENTRY_SIZE)
+				entries = (uint32_t)((length - PACKED_BATCH_ENTRIES) / PACKED_BATCH_ENTRY_SIZE);
+
+			const uint8_t* entry = packet + PACKED_BATCH_ENTRIES;
+
+			for (uint32_t i = 0; i < entries; i++, entry += PACKED_BATCH_ENTRY_SIZE) {
+				entity_update(entity_slot((Entity)packed_read_uint32(entry, PACKED_BATCH_ENTRY_ENTITY)), (Vector2){ packed_read_float(entry, PACKED_BATCH_ENTRY_POSITION_X), packed_read_float(entry, PACKED_BATCH_ENTRY_POSITION_Y) }, (Vector2){ packed_read_float(entry, PACKED_BATCH_ENTRY_SPEED_X), packed_read_float(entry, PACKED_BATCH_ENTRY_SPEED_Y) });
+			}
+		#endif
+	} else if (id == NET_MESSAGE_SPAWN_BATCH) {
+		#ifdef NETDYNAMICS_CLIENT
+			if (length < PACKED_BATCH_ENTRIES)
+				return id;
+
+			uint32_t entries = packed_read_uint16(packet, PACKED_BATCH_COUNT);
+
+			if (entries > (length - PACKED_BATCH_ENTRIES) / PACKED_SPAWN_BATCH_ENTRY_SIZE)
+				entries = (uint32_t)((length - PACKED_BATCH_ENTRIES) / PACKED_SPAWN_BATCH_ENTRY_SIZE);
+
+			const uint8_t* entry = packet + PACKED_BATCH_ENTRIES;
+
+			for (uint32_t i = 0; i < entries; i++, entry += PACKED_SPAWN_BATCH_ENTRY_SIZE) {
+				entity_spawn((Entity)packed_read_uint32(entry, PACKED_SPAWN_BATCH_ENTRY_ENTITY), (Vector2){ packed_read_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_X), packed_read_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_Y) }, (Vector2){ packed_read_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_X), packed_read_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_Y) }, (Color){ packed_read_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_R), packed_read_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_G), packed_read_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_B), 255 });
+			}
+		#endif
+	} else if (id == NET_MESSAGE_MOVE_QUANTIZED) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+
+			length = latency_receive(packet, length);
+
+			if (length < PACKED_QUANTIZED_ENTRIES)
+				return id;
+
+			uint32_t first = packed_read_uint32(packet, PACKED_QUANTIZED_FIRST);
+			uint32_t entries = packed_read_uint16(packet, PACKED_QUANTIZED_COUNT);
+			uint32_t positionBits = packed_read_uint8(packet, PACKED_QUANTIZED_POSITION_BITS);
+			uint32_t speedBits = packed_read_uint8(packet, PACKED_QUANTIZED_SPEED_BITS);
+			float minimumX = -textureWidth, maximumX = packed_read_uint16(packet, PACKED_QUANTIZED_WIDTH) + textureWidth;
+			float minimumY = -textureHeight, maximumY = packed_read_uint16(packet, PACKED_QUANTIZED_HEIGHT) + textureHeight;
+			BitReader reader = { packet, PACKED_QUANTIZED_ENTRIES, length };
+
+			if (positionBits == 0 || positionBits > NET_QUANTIZATION_MAX_POSITION_BITS || speedBits == 0 || speedBits > NET_QUANTIZATION_MAX_SPEED_BITS || first + entries > NET_MAX_ENTITIES)
+				return id;
+
+			for (uint32_t i = first; i < first + entries; i++) {
+				uint32_t present, x, y, speedX, speedY;
+
+				if (!packed_read_bits(&reader, 1, &present))
+					break;
+
+				if (!present)
+					continue;
+
+				if (!packed_read_bits(&reader, positionBits, &x) || !packed_read_bits(&reader, positionBits, &y) || !packed_read_bits(&reader, speedBits, &speedX) || !packed_read_bits(&reader, speedBits, &speedY))
+					break;
+
+				entity_update(entity_lookup(i), (Vector2){ dequantize(x, minimumX, maximumX, positionBits), dequantize(y, minimumY, maximumY, positionBits) }, (Vector2){ dequantize(speedX, -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, speedBits), dequantize(speedY, -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, speedBits) });
+			}
+		#endif
+	} else if (id == NET_MESSAGE_MOVE_DELTA) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+
+			length = latency_receive(packet, length);
+
+			if (length < PACKED_DELTA_ENTRIES)
+				return id;
+
+			uint32_t sequence = packed_read_uint32(packet, PACKED_DELTA_SEQUENCE);
+			uint32_t baseline = packed_read_uint32(packet, PACKED_DELTA_BASELINE);
+			uint32_t total = packed_read_uint32(packet, PACKED_DELTA_TOTAL);
+			uint32_t first = packed_read_uint32(packet, PACKED_DELTA_FIRST);
+			uint32_t entries = packed_read_uint16(packet, PACKED_DELTA_COUNT);
+			uint32_t slot = sequence % NET_SNAPSHOT_HISTORY;
+
+			if (total > NET_MAX_ENTITIES || first + entries > total)
+				return id;
+
+			if (!snapshot_reserve(total))
+				return id;
+
+			if (baseline != 0 && (snapshotSequence[baseline % NET_SNAPSHOT_HISTORY] != baseline || snapshotReceived[baseline % NET_SNAPSHOT_HISTORY] < snapshotTotal[baseline % NET_SNAPSHOT_HISTORY]))
+				return id;
+
+			if (snapshotSequence[slot] != sequence) {
+				if (snapshotSequence[slot] > sequence)
+					return id;
+
+				snapshotSequence[slot] = sequence;
+				snapshotReceived[slot] = 0;
+				snapshotTotal[slot] = total;
+
+				memset(SNAPSHOT_CHUNKS(sequence), 0, sizeof(uint32_t) * (snapshotStride / 32));
+			}
+
+			// Chunks of a snapshot never overlap, so a chunk that starts at a known index is a duplicate
+			uint32_t* chunks = SNAPSHOT_CHUNKS(sequence);
+
+			if (chunks[first / 32] & (1u << (first % 32)))
+				return id;
+
+			int32_t* current = SNAPSHOT_SLOT(sequence);
+			const int32_t* previous = (baseline != 0) ? SNAPSHOT_SLOT(baseline) : NULL;
+			size_t offset = PACKED_DELTA_ENTRIES;
+			uint32_t decoded = 0;
+
+			for (uint32_t i = first; i < first + entries; i++, decoded++) {
+				int32_t x, y;
+				uint8_t flags;
+
+				if (offset >= length)
+					break;
+
+				flags = packed_read_uint8(packet, offset++);
+
+				if (flags & PACKED_DELTA_FLAG_EMPTY)
+					continue;
+
+				if (!packed_read_varint(packet, &offset, length, &x) || !packed_read_varint(packet, &offset, length, &y))
+					break;
+
+				if ((flags & PACKED_DELTA_FLAG_ABSOLUTE) == 0) {
+					if (previous == NULL)
+						break;
+
+					x += previous[i * 2];
+					y += previous[i * 2 + 1];
+				}
+
+				current[i * 2] = x;
+				current[i * 2 + 1] = y;
+
+				uint32_t slot = entity_lookup(i);
+				Vector2 speedComponent = { 0.0f, 0.0f };
+
+				if (slot != ENTITY_NONE)
+					speedComponent = (Vector2){ components.speedX[slot], components.speedY[slot] };
+
+				if (flags & PACKED_DELTA_FLAG_SPEED) {
+					if (offset + 8 > length)
+						break;
+
+					speedComponent = (Vector2){ packed_read_float(packet, offset), packed_read_float(packet, offset + 4) };
+					offset += 8;
+				}
+
+				if (flags & PACKED_DELTA_FLAG_COLOR) {
+					if (offset + 3 > length)
+						break;
+
+					if (slot != ENTITY_NONE)
+						components.color[slot] = (Color){ packed_read_uint8(packet, offset), packed_read_uint8(packet, offset + 1), packed_read_uint8(packet, offset + 2), 255 };
+
+					offset += 3;
+				}
+
+				entity_update(slot, (Vector2){ x / NET_SNAPSHOT_PRECISION, y / NET_SNAPSHOT_PRECISION }, speedComponent);
+			}
+
+			if (decoded < entries)
+				return id;
+
+			chunks[first / 32] |= 1u << (first % 32);
+
+			// Acknowledge a snapshot once it was received completely, so the server can use it as a baseline
+			if ((snapshotReceived[slot] += entries) == total) {
+				uint8_t ack[PACKED_ACK_SIZE];
+
+				packed_write_uint8(ack, PACKED_HEADER_ID, NET_MESSAGE_ACK);
+				packed_write_uint32(ack, PACKED_ACK_SEQUENCE, sequence);
+
+				packet_send(client, ack, sizeof(ack), NET_CHANNEL_STATE);
+			}
+		#endif
+	} else if (id == NET_MESSAGE_VIEW) {
+		#ifdef NETDYNAMICS_SERVER
+			if (length >= PACKED_VIEW_SIZE)
+				views[transport->identify(client)] = (Rectangle){ packed_read_float(packet, PACKED_VIEW_X), packed_read_float(packet, PACKED_VIEW_Y), packed_read_float(packet, PACKED_VIEW_WIDTH), packed_read_float(packet, PACKED_VIEW_HEIGHT) };
+		#endif
+	} else if (id == NET_MESSAGE_ACK) {
+		#ifdef NETDYNAMICS_SERVER
+			if (length >= PACKED_ACK_SIZE) {
+				uint32_t sequence = packed_read_uint32(packet, PACKED_ACK_SEQUENCE);
+				uint32_t* peerAcknowledged = &acknowledged[transport->identify(client)];
+
+				if (sequence < snapshot && sequence > *peerAcknowledged)
+					*peerAcknowledged = sequence;
+			}
+		#endif
+	} else if (id == NET_MESSAGE_DESTROY) {
+		#ifdef NETDYNAMICS_CLIENT
+			if (length >= PACKED_DESTROY_SIZE)
+				entity_destroy((Entity)packed_read_uint32(packet, PACKED_DESTROY_ENTITY));
+		#endif
+	} else if (id == NET_MESSAGE_DESTROY_RANGE) {
+		#ifdef NETDYNAMICS_CLIENT
+			if (length < PACKED_BATCH_ENTRIES)
+				return id;
+
+			uint32_t entries = packed_read_uint16(packet, PACKED_BATCH_COUNT);
+
+			if (entries > (length - PACKED_BATCH_ENTRIES) / PACKED_DESTROY_RANGE_SIZE)
+				entries = (uint32_t)((length - PACKED_BATCH_ENTRIES) / PACKED_DESTROY_RANGE_SIZE);
+
+			const uint8_t* entry = packet + PACKED_BATCH_ENTRIES;
+
+			for (uint32_t i = 0; i < entries; i++, entry += PACKED_DESTROY_RANGE_SIZE) {
+				entity_destroy_range((Entity)packed_read_uint32(entry, PACKED_DESTROY_RANGE_FIRST), packed_read_uint16(entry, PACKED_DESTROY_RANGE_COUNT));
+			}
+		#endif
+	}
+
+	return id;
+}
+
+inline static uint8_t message_receive(void* client, uint8_t* packet, size_t length) {
+	if (length == 0)
+		return 0;
+
+	#ifdef NETDYNAMICS_CLIENT
+		// Messages without a stamp are sampled on arrival
+		stateTime = 0;
+		stateClock = interpolationClock;
+	#endif
+
+	if (packet[0] != BINN_LIST)
+		return message_unpack(client, packet, length);
+
+	binn* data = binn_open(packet);
+	uint8_t id = binn_list_uint8(data, 1);
+
+	if (id == NET_MESSAGE_SPAWN) {
+		#ifdef NETDYNAMICS_SERVER
+			entity_spawn((Vector2){ binn_list_float(data, 2), binn_list_float(data, 3) }, NET_MAX_ENTITY_SPAWN);
+		#elif NETDYNAMICS_CLIENT
+			entity_spawn((Entity)binn_list_uint32(data, 2), (Vector2){ binn_list_float(data, 3), binn_list_float(data, 4) }, (Vector2){ binn_list_float(data, 5), binn_list_float(data, 6) }, (Color){ binn_list_uint8(data, 7), binn_list_uint8(data, 8), binn_list_uint8(data, 9), 255 });
+		#endif
+	} else if (id == NET_MESSAGE_MOVE) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+
+			entity_update(entity_slot((Entity)binn_list_uint32(data, 2)), (Vector2){ binn_list_float(data, 3), binn_list_float(data, 4) }, (Vector2){ binn_list_float(data, 5), binn_list_float(data, 6) });
+		#endif
+	} else if (id == NET_MESSAGE_MOVE_BATCH) {
+		#ifdef NETDYNAMICS_CLIENT
+			lag_update();
+			latency_receive(packet, length);
+
+			binn_iter iter;
+			uint32_t entries = (binn_count(data) - 1) / 5;
+
+			binn_iter_init(&iter, data, BINN_LIST);
+			binn_next_uint32(&iter);
+
+			for (uint32_t i = 0; i < entries; i++) {
+				Entity entityRemote = (Entity)binn_next_uint32(&iter);
+				Vector2 positionComponent, speedComponent;
+
+				positionComponent.x = binn_next_float(&iter);
+				positionComponent.y = binn_next_float(&iter);
+				speedComponent.x = binn_next_float(&iter);
+				speedComponent.y = binn_next_float(&iter);
+
+				entity_update(entity_slot(entityRemote), positionComponent, speedComponent);
+			}
+		#endif
+	} else if (id == NET_MESSAGE_SPAWN_BATCH) {
+		#ifdef NETDYNAMICS_CLIENT
+			binn_iter iter;
+			uint32_t entries = (binn_count(data) - 1) / 8;
+
+			binn_iter_init(&iter, data, BINN_LIST);
+			binn_next_uint32(&iter);
+
+			for (uint32_t i = 0; i < entries; i++) {
+				Entity entityRemote = (Entity)binn_next_uint32(&iter);
+				Vector2 positionComponent, speedComponent;
+				Color colorComponent = { 0, 0, 0, 255 };
+
+				positionComponent.x = binn_next_float(&iter);
+				positionComponent.y = binn_next_float(&iter);
+				speedComponent.x = binn_next_float(&iter);
+				speedComponent.y = binn_next_float(&iter);
+				colorComponent.r = binn_next_uint8(&iter);
+				colorComponent.g = binn_next_uint8(&iter);
+				colorComponent.b = binn_next_uint8(&iter);
+
+				entity_spawn(entityRemote, positionComponent, speedComponent, colorComponent);
+			}
+		#endif
+	} else if (id == NET_MESSAGE_VIEW) {
+		#ifdef NETDYNAMICS_SERVER
+			views[transport->identify(client)] = (Rectangle){ binn_list_float(data, 2), binn_list_float(data, 3), binn_list_float(data, 4), binn_list_float(data, 5) };
+		#endif
+	} else if (id == NET_MESSAGE_DESTROY) {
+		#ifdef NETDYNAMICS_CLIENT
+			entity_destroy((Entity)binn_list_uint32(data, 2));
+		#endif
+	} else if (id == NET_MESSAGE_DESTROY_RANGE) {
+		#ifdef NETDYNAMICS_CLIENT
+			binn_iter iter;
+			uint32_t entries = (binn_count(data) - 1) / 2;
+
+			binn_iter_init(&iter, data, BINN_LIST);
+			binn_next_uint32(&iter);
+
+			for (uint32_t i = 0; i < entries; i++) {
+				Entity first = (Entity)binn_next_uint32(&iter);
+				uint32_t count = binn_next_uint32(&iter);
+
+				entity_destroy_range(first, count);
+			}
+		#endif
+	}
+
+	binn_free(data);
+
+	return id;
+}
+
+inline static float get_frame_time(void) {
+	if (!settings.headlessMode)
+		return RayGetFrameTime();
+
+	static uint64_t currentTime;
+	static uint64_t lastTime;
+	static float deltaTime;
+
+	if (aws_high_res_clock_get_ticks(&currentTime) == AWS_OP_SUCCESS) {
+		if (lastTime > 0)
+			deltaTime = ((currentTime - lastTime) / 1000000.0f) / 1000.0f;
+
+		lastTime = currentTime;
+	}
+
+	return deltaTime;
+}
+
+// Timing
+
+typedef struct _Timing {
+	float accumulator;
+	float tickInterval;
+	uint64_t deadline;
+} Timing;
+
+static Timing timing;
+
+// Returns how many fixed ticks are due, frames that fell too far behind drop the rest instead of spiraling
+inline static uint32_t timing_ticks(float deltaTime) {
+	if (settings.tickRate == 0)
+		return 1;
+
+	uint32_t ticks = 0;
+
+	timing.accumulator += deltaTime;
+
+	while (timing.accumulator >= timing.tickInterval && ticks < settings.maxCatchUp) {
+		timing.accumulator -= timing.tickInterval;
+		ticks++;
+	}
+
+	if (ticks == settings.maxCatchUp && timing.accumulator >= timing.tickInterval)
+		timing.accumulator = 0.0f;
+
+	return ticks;
+}
+
+inline static float timing_step(float deltaTime) {
+	return (settings.tickRate > 0) ? timing.tickInterval : deltaTime;
+}
+
+// Sleeps until the next deadline rather than for a constant interval, so the time spent on work isn't added on top
+inline static void timing_sleep(void) {
+	uint64_t interval = 1000000000 / ((settings.tickRate > 0) ? settings.tickRate : settings.framerateLimit);
+	uint64_t currentTime = 0;
+
+	aws_high_res_clock_get_ticks(&currentTime);
+
+	if (timing.deadline == 0)
+		timing.deadline = currentTime;
+
+	timing.deadline += interval;
+
+	if (timing.deadline > currentTime)
+		aws_thread_current_sleep(timing.deadline - currentTime);
+	else if (currentTime - timing.deadline > interval * settings.maxCatchUp)
+		timing.deadline = currentTime;
+}
+
+// Scheduling
+
+#ifdef NETDYNAMICS_SERVER
+	static uint32_t* schedulerCandidates;
+	static uint32_t schedulerCapacity;
+
+	// Number of entries that fit into the budget including packet headers and redundant bytes
+	inline static uint32_t scheduler_entries(void) {
+		uint32_t entrySize = (settings.serializer == NET_SERIALIZER_PACKED) ? PACKED_BATCH_ENTRY_SIZE : MOVE_ENTRY_SIZE;
+		uint32_t headerSize = ((settings.serializer == NET_SERIALIZER_PACKED) ? PACKED_BATCH_ENTRIES : MOVE_ENTRY_SIZE) + settings.redundantBytes;
+		uint32_t capacity = message_batch_capacity();
+
+		if (settings.serializer != NET_SERIALIZER_PACKED && capacity > settings.maxPayload / entrySize)
+			capacity = settings.maxPayload / entrySize;
+
+		uint32_t packetSize = capacity * entrySize + headerSize;
+		uint32_t entries = (settings.budget / packetSize) * capacity;
+		uint32_t rest = settings.budget % packetSize;
+
+		if (rest > headerSize)
+			entries += (rest - headerSize) / entrySize;
+
+		// A budget below a single packet still sends the top entity, otherwise the priorities would grow forever
+		return (entries > 0) ? entries : 1;
+	}
+
+	inline static void scheduler_swap(uint32_t* slots, uint32_t a, uint32_t b) {
+		uint32_t slot = slots[a];
+
+		slots[a] = slots[b];
+		slots[b] = slot;
+	}
+
+	// Moves the highest priorities to the front without sorting the rest
+	inline static void scheduler_partition(uint32_t* slots, uint32_t count, uint32_t selected, const float* priority) {
+		uint32_t first = 0, last = count;
+
+		while (last - first > 1) {
+			float pivot = priority[slots[first + (last - first) / 2] * NET_MAX_CLIENTS];
+			uint32_t lower = first, equal = first, upper = last;
+
+			while (equal < upper) {
+				float value = priority[slots[equal] * NET_MAX_CLIENTS];
+
+				if (value > pivot)
+					scheduler_swap(slots, lower++, equal++);
+				else if (value < pivot)
+					scheduler_swap(slots, equal, --upper);
+				else
+					equal++;
+			}
+
+			if (selected < lower)
+				last = lower;
+			else if (selected > equal)
+				first = equal;
+			else
+				return;
+		}
+	}
+
+	// Accumulates priority for the candidates and returns how many at the front of the list should be sent to the client
+	inline static uint32_t scheduler_select(uint32_t client, uint32_t* slots, uint32_t count, const Rectangle* view, float elapsed) {
+		float* priority = components.priority + client;
+		float centerX = settings.resolutionWidth / 2.0f, centerY = settings.resolutionHeight / 2.0f;
+
+		if (view->width > 0.0f && view->height > 0.0f) {
+			centerX = view->x + view->width / 2.0f;
+			centerY = view->y + view->height / 2.0f;
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t slot = slots[i];
+			float speed = sqrtf(components.speedX[slot] * components.speedX[slot] + components.speedY[slot] * components.speedY[slot]);
+			float distanceX = components.positionX[slot] - centerX, distanceY = components.positionY[slot] - centerY;
+			float distance = sqrtf(distanceX * distanceX + distanceY * distanceY);
+
+			priority[slot * NET_MAX_CLIENTS] += elapsed * (1.0f + speed * NET_SCHEDULER_SPEED_WEIGHT) / (1.0f + distance * NET_SCHEDULER_DISTANCE_WEIGHT);
+		}
+
+		uint32_t selected = scheduler_entries();
+
+		if (selected < count)
+			scheduler_partition(slots, count, selected, priority);
+		else
+			selected = count;
+
+		for (uint32_t i = 0; i < selected; i++) {
+			priority[slots[i] * NET_MAX_CLIENTS] = 0.0f;
+		}
+
+		return selected;
+	}
+
+	inline static uint32_t* scheduler_candidates(void) {
+		if (schedulerCapacity < entities.capacity) {
+			uint32_t* candidates = (uint32_t*)je_realloc(schedulerCandidates, sizeof(uint32_t) * entities.capacity);
+
+			if (candidates == NULL)
+				return NULL;
+
+			schedulerCandidates = candidates;
+			schedulerCapacity = entities.capacity;
+		}
+
+		for (uint32_t i = 0; i < entities.count; i++) {
+			schedulerCandidates[i] = i;
+		}
+
+		return schedulerCandidates;
+	}
+#endif
+
+// Streaming
+
+#ifdef NETDYNAMICS_SERVER
+	#define SPAWN_ENTRY_SIZE 30 // Worst case of an entity, four floats and three bytes with a byte of type per item
+	#define DESTROY_RANGE_ENTRY_SIZE 10 // Worst case of an entity and a count with a byte of type per item
+
+	typedef struct _Stream {
+		uint32_t cursor;
+		bool active;
+	} Stream;
+
+	static Stream streams[NET_MAX_CLIENTS];
+
+	// Walks the index space instead of dense slots since removals reorder them while the stream is in progress
+	inline static uint32_t stream_encode(void* client, uint32_t cursor) {
+		uint32_t capacity = (settings.streamChunkSize - PACKED_BATCH_ENTRIES - settings.redundantBytes) / PACKED_SPAWN_BATCH_ENTRY_SIZE;
+		uint32_t entries = 0;
+
+		if (settings.serializer == NET_SERIALIZER_PACKED) {
+			uint8_t* buffer = packet_allocate(settings.streamChunkSize);
+			uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+			for (; cursor < entities.indices && entries < capacity; cursor++) {
+				uint32_t slot = entity_lookup(cursor);
+
+				if (slot == ENTITY_NONE)
+					continue;
+
+				message_pack_spawn_entry(entry, slot);
+
+				entry += PACKED_SPAWN_BATCH_ENTRY_SIZE;
+				entries++;
+			}
+
+			if (entries > 0) {
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_SPAWN_BATCH);
+				packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+				packet_submit(client, buffer, packed_write_redundancy(buffer, PACKED_BATCH_ENTRIES + entries * PACKED_SPAWN_BATCH_ENTRY_SIZE), NET_CHANNEL_BULK);
+			} else {
+				packet_release(buffer);
+			}
+
+			return cursor;
+		}
+
+
+		binn* data = binn_list();
+
+		binn_list_add_uint8(data, NET_MESSAGE_SPAWN_BATCH);
+
+		for (; cursor < entities.indices && binn_size(data) + SPAWN_ENTRY_SIZE + settings.redundantBytes <= settings.streamChunkSize; cursor++) {
+			uint32_t slot = entity_lookup(cursor);
+
+			if (slot == ENTITY_NONE)
+				continue;
+
+			message_add_spawn_entry(data, slot);
+
+			entries++;
+		}
+
+		if (entries > 0) {
+			if (settings.redundantBytes > 0)
+				binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+			packet_send(client, binn_ptr(data), binn_size(data), NET_CHANNEL_BULK);
+		}
+
+		binn_free(data);
+
+		return cursor;
+	}
+
+	inline static void stream_start(uint32_t client) {
+		streams[client].cursor = 0;
+		streams[client].active = true;
+	}
+
+	inline static void stream_stop(uint32_t client) {
+		streams[client].active = false;
+	}
+
+	// Entities spawned or destroyed meanwhile are broadcast as usual, spawning the same handle again is harmless on the client and destroys of streamed entities are repeated once the stream is over
+	inline static void stream_update(void) {
+		for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+			if (!streams[i].active || clients[i] == NULL)
+				continue;
+
+			for (uint32_t chunk = 0; chunk < settings.streamChunks && streams[i].cursor < entities.indices; chunk++) {
+				streams[i].cursor = stream_encode(clients[i], streams[i].cursor);
+			}
+
+			if (streams[i].cursor >= entities.indices)
+				stream_stop(i);
+		}
+	}
+#endif
+
+// Rendering
+
+#define RENDER_BATCH_VERTICES 6 // Two unindexed triangles per entity since mesh indices are 16-bit
+#define RENDER_BATCH_CAPACITY 4096
+
+typedef struct _RenderBatch {
+	Mesh mesh;
+	Material material;
+	uint32_t capacity;
+} RenderBatch;
+
+static RenderBatch renderBatch;
+
+// Vertex arrays are owned here, so the mesh is unloaded through a copy that doesn't let raylib free them
+inline static void render_batch_unload(void) {
+	if (renderBatch.capacity == 0)
+		return;
+
+	Mesh mesh = renderBatch.mesh;
+
+	mesh.vertices = NULL;
+	mesh.texcoords = NULL;
+	mesh.colors = NULL;
+
+	rlUnloadMesh(&mesh);
+}
+
+inline static bool render_batch_reserve(uint32_t capacity) {
+	if (capacity <= renderBatch.capacity)
+		return true;
+
+	uint32_t required = (renderBatch.capacity > 0) ? renderBatch.capacity : RENDER_BATCH_CAPACITY;
+
+	while (required < capacity) {
+		required *= 2;
+	}
+
+	uint32_t vertices = required * RENDER_BATCH_VERTICES;
+	float* positions = (float*)je_realloc(renderBatch.mesh.vertices, sizeof(float) * 3 * vertices);
+
+	if (positions != NULL)
+		renderBatch.mesh.vertices = positions;
+
+	float* texcoords = (float*)je_realloc(renderBatch.mesh.texcoords, sizeof(float) * 2 * vertices);
+
+	if (texcoords != NULL)
+		renderBatch.mesh.texcoords = texcoords;
+
+	unsigned char* colors = (unsigned char*)je_realloc(renderBatch.mesh.colors, sizeof(unsigned char) * 4 * vertices);
+
+	if (colors != NULL)
+		renderBatch.mesh.colors = colors;
+
+	if (positions == NULL || texcoords == NULL || colors == NULL)
+		return false;
+
+	static const float quad[RENDER_BATCH_VERTICES * 2] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f };
+
+	for (uint32_t i = renderBatch.capacity; i < required; i++) {
+		memcpy(&texcoords[i * RENDER_BATCH_VERTICES * 2], quad, sizeof(quad));
+	}
+
+	memset(positions, 0, sizeof(float) * 3 * vertices);
+
+	render_batch_unload();
+
+	if (renderBatch.capacity == 0) {
+		renderBatch.material = RayLoadMaterialDefault();
+		renderBatch.material.maps[MAP_DIFFUSE].texture = texture;
+	}
+
+	renderBatch.mesh.vertexCount = (int)vertices;
+	renderBatch.mesh.triangleCount = (int)(required * 2);
+	renderBatch.capacity = required;
+
+	rlLoadMesh(&renderBatch.mesh, true);
+
+	return true;
+}
+
+// Streams positions and colors into a dynamic vertex buffer and draws every entity with one call
+inline static bool render_batch_draw(void) {
+	if (!render_batch_reserve(entities.count))
+		return false;
+
+	float* positions = renderBatch.mesh.vertices;
+	uint32_t* colors = (uint32_t*)renderBatch.mesh.colors;
+
+	for (uint32_t i = 0; i < entities.count; i++, positions += RENDER_BATCH_VERTICES * 3, colors += RENDER_BATCH_VERTICES) {
+		float left = components.positionX[i], top = components.positionY[i];
+		float right = left + textureWidth, bottom = top + textureHeight;
+		float cornersX[RENDER_BATCH_VERTICES] = { left, left, right, left, right, right };
+		float cornersY[RENDER_BATCH_VERTICES] = { top, bottom, bottom, top, bottom, top };
+		uint32_t color;
+
+		memcpy(&color, &components.color[i], sizeof(uint32_t));
+
+		for (uint32_t j = 0; j < RENDER_BATCH_VERTICES; j++) {
+			positions[j * 3] = cornersX[j];
+			positions[j * 3 + 1] = cornersY[j];
+			colors[j] = color;
+		}
+	}
+
+	Mesh mesh = renderBatch.mesh;
+
+	mesh.vertexCount = (int)(entities.count * RENDER_BATCH_VERTICES);
+	mesh.triangleCount = (int)(entities.count * 2);
+
+	rlUpdateMesh(mesh, 0, mesh.vertexCount);
+	rlUpdateMesh(mesh, 3, mesh.vertexCount);
+
+	// Anything drawn earlier through the immediate-mode batch has to land below the entities
+	rlglDraw();
+	rlDrawMesh(mesh, renderBatch.material, (Matrix){ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f });
+
+	return true;
+}
+
+inline static void render_batch_destroy(void) {
+	render_batch_unload();
+
+	// The diffuse map is the shared entity texture, which is unloaded on its own
+	if (renderBatch.capacity > 0) {
+		renderBatch.material.maps[MAP_DIFFUSE].texture = (Texture2D){ 0 };
+
+		RayUnloadMaterial(renderBatch.material);
+	}
+
+	je_free(renderBatch.mesh.vertices);
+	je_free(renderBatch.mesh.texcoords);
+	je_free(renderBatch.mesh.colors);
+
+	memset(&renderBatch, 0, sizeof(renderBatch));
+}
+
+// Compression
+
+#ifdef NETDYNAMICS_COMPRESSION
+	typedef struct _Compressor {
+		uint8_t* input;
+		void* lz4State;
+		ZSTD_CCtx* zstdCompression;
+		ZSTD_DCtx* zstdDecompression;
+		struct aws_atomic_var inputBytes;
+		struct aws_atomic_var outputBytes;
+		struct aws_atomic_var datagrams;
+		struct aws_atomic_var ticks;
+	} Compressor;
+
+	static Compressor compressor;
+
+	// ENet hands over a datagram as several buffers, the codecs want it contiguous
+	static size_t compressor_compress(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData, size_t outLimit) {
+		Compressor* compressorLocal = (Compressor*)context;
+		uint64_t startTime = 0, endTime = 0;
+		size_t length = 0;
+
+		if (inLimit < settings.compressionThreshold || inLimit > NET_COMPRESSION_BUFFER_SIZE)
+			return 0;
+
+		aws_high_res_clock_get_ticks(&startTime);
+
+		for (size_t i = 0; i < inBufferCount; i++) {
+			memcpy(compressorLocal->input + length, inBuffers[i].data, inBuffers[i].dataLength);
+			length += inBuffers[i].dataLength;
+		}
+
+		size_t result = 0;
+
+		if (settings.compression == NET_COMPRESSION_LZ4) {
+			int size = LZ4_compress_fast_extState(compressorLocal->lz4State, (const char*)compressorLocal->input, (char*)outData, (int)length, (int)outLimit, 1);
+
+			if (size > 0)
+				result = (size_t)size;
+		} else if (settings.compression == NET_COMPRESSION_ZSTD) {
+			size_t size = ZSTD_compressCCtx(compressorLocal->zstdCompression, outData, outLimit, compressorLocal->input, length, settings.compressionLevel);
+
+			if (!ZSTD_isError(size))
+				result = size;
+		}
+
+		aws_high_res_clock_get_ticks(&endTime);
+
+		// Relaxed counters since they are only sampled for the overlay
+		aws_atomic_fetch_add_explicit(&compressorLocal->inputBytes, length, aws_memory_order_relaxed);
+		aws_atomic_fetch_add_explicit(&compressorLocal->outputBytes, (result > 0 && result < length) ? result : length, aws_memory_order_relaxed);
+		aws_atomic_fetch_add_explicit(&compressorLocal->datagrams, 1, aws_memory_order_relaxed);
+		aws_atomic_fetch_add_explicit(&compressorLocal->ticks, (size_t)(endTime - startTime), aws_memory_order_relaxed);
+
+		return (result < length) ? result : 0;
+	}
+
+	static size_t compressor_decompress(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit) {
+		Compressor* compressorLocal = (Compressor*)context;
+
+		if (settings.compression == NET_COMPRESSION_LZ4) {
+			int size = LZ4_decompress_safe((const char*)inData, (char*)outData, (int)inLimit, (int)outLimit);
+
+			return (size > 0) ? (size_t)size : 0;
+		} else if (settings.compression == NET_COMPRESSION_ZSTD) {
+			size_t size = ZSTD_decompressDCtx(compressorLocal->zstdDecompression, outData, outLimit, inData, inLimit);
+
+			return ZSTD_isError(size) ? 0 : size;
+		}
+
+		return 0;
+	}
+
+	static void compressor_destroy(void* context) {
+		Compressor* compressorLocal = (Compressor*)context;
+
+		ZSTD_freeCCtx(compressorLocal->zstdCompression);
+		ZSTD_freeDCtx(compressorLocal->zstdDecompression);
+		je_free(compressorLocal->lz4State);
+		je_free(compressorLocal->input);
+
+		compressorLocal->zstdCompression = NULL;
+		compressorLocal->zstdDecompression = NULL;
+		compressorLocal->lz4State = NULL;
+		compressorLocal->input = NULL;
+	}
+
+	// Contexts and buffers are allocated once so that nothing is allocated per datagram
+	inline static bool compressor_create(ENetHost* host) {
+		// Hosts of the load generator share the contexts owned by the first one
+		if (compressor.input != NULL) {
+			ENetCompressor callbacks = {
+				&compressor,
+				compressor_compress,
+				compressor_decompress,
+				NULL
+			};
+
+			enet_host_compress(host, &callbacks);
+
+			return true;
+		}
+
+		aws_atomic_init_int(&compressor.inputBytes, 0);
+		aws_atomic_init_int(&compressor.outputBytes, 0);
+		aws_atomic_init_int(&compressor.datagrams, 0);
+		aws_atomic_init_int(&compressor.ticks, 0);
+
+		if ((compressor.input = (uint8_t*)je_malloc(NET_COMPRESSION_BUFFER_SIZE)) == NULL)
+			return false;
+
+		bool created = false;
+
+		if (settings.compression == NET_COMPRESSION_LZ4) {
+			created = (compressor.lz4State = je_malloc(LZ4_sizeofState())) != NULL;
+		} else if (settings.compression == NET_COMPRESSION_ZSTD) {
+			compressor.zstdCompression = ZSTD_createCCtx();
+			compressor.zstdDecompression = ZSTD_createDCtx();
+			created = compressor.zstdCompression != NULL && compressor.zstdDecompression != NULL;
+		}
+
+		if (!created) {
+			compressor_destroy(&compressor);
+
+			return false;
+		}
+
+		ENetCompressor callbacks = {
+			&compressor,
+			compressor_compress,
+			compressor_decompress,
+			compressor_destroy
+		};
+
+		enet_host_compress(host, &callbacks);
+
+		return true;
+	}
+#endif
+
+// Callbacks
+
+static int ini_callback(void* data, const char* section, const char* name, const char* value) {
+	#define FIELD_MATCH(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
+	#define PARSE_INTEGER(v) strtoul(v, NULL, 10)
+	#define PARSE_STRING(v) strdup(v)
+	#define PARSE_FLOAT(v) strtof(v, NULL)
+
+	Settings* settings = (Settings*)data;
+
+	if (FIELD_MATCH("Display", "HeadlessMode"))
+		settings->headlessMode = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Display", "ResolutionWidth"))
+		settings->resolutionWidth = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Display", "ResolutionHeight"))
+		settings->resolutionHeight = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Renderer", "FramerateLimit"))
+		settings->framerateLimit = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Renderer", "VSync"))
+		settings->vsync = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Renderer", "MeshBatch"))
+		settings->meshBatch = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "Transport"))
+		settings->transport = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "IP"))
+		settings->ip = PARSE_STRING(value);
+	else if (FIELD_MATCH("Network", "Port"))
+		settings->port = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "SendRate"))
+		settings->sendRate = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "RedundantBytes"))
+		settings->redundantBytes = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "BatchSize"))
+		settings->batchSize = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "MaxPayload"))
+		settings->maxPayload = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "Serializer"))
+		settings->serializer = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "DeltaCompression"))
+		settings->deltaCompression = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Quantization", "PositionBits"))
+		settings->positionBits = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Quantization", "SpeedBits"))
+		settings->speedBits = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "Kernel"))
+		settings->kernel = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "NetworkThread"))
+		settings->networkThread = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "Workers"))
+		settings->workers = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "Profiler"))
+		settings->profiler = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "Latency"))
+		settings->latency = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "Arena"))
+		settings->arena = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Systems", "ArenaSize"))
+		settings->arenaSize = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "Enabled"))
+		settings->interest = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "CellSize"))
+		settings->cellSize = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "ViewX"))
+		settings->viewX = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "ViewY"))
+		settings->viewY = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "ViewWidth"))
+		settings->viewWidth = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interest", "ViewHeight"))
+		settings->viewHeight = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Scheduler", "Enabled"))
+		settings->scheduler = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Scheduler", "Budget"))
+		settings->budget = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Stream", "ChunkSize"))
+		settings->streamChunkSize = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Stream", "Chunks"))
+		settings->streamChunks = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "Compression"))
+		settings->compression = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "CompressionThreshold"))
+		settings->compressionThreshold = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "CompressionLevel"))
+		settings->compressionLevel = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Network", "SocketBufferDatagrams"))
+		settings->socketBufferDatagrams = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Metrics", "Format"))
+		settings->metrics = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Metrics", "Interval"))
+		settings->metricsInterval = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Metrics", "File"))
+		settings->metricsFile = PARSE_STRING(value);
+	else if (FIELD_MATCH("Load", "Clients"))
+		settings->loadClients = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Benchmark", "Scenario"))
+		settings->scenario = PARSE_STRING(value);
+	else if (FIELD_MATCH("Benchmark", "Warmup"))
+		settings->benchmarkWarmup = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Benchmark", "Repetitions"))
+		settings->benchmarkRepetitions = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Benchmark", "Output"))
+		settings->benchmarkFile = PARSE_STRING(value);
+	else if (FIELD_MATCH("Timing", "TickRate"))
+		settings->tickRate = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interpolation", "Delay"))
+		settings->interpolationDelay = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Interpolation", "Extrapolation"))
+		settings->extrapolationLimit = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Capture", "File"))
+		settings->captureFile = PARSE_STRING(value);
+	else if (FIELD_MATCH("Capture", "Replay"))
+		settings->replay = PARSE_STRING(value);
+	else if (FIELD_MATCH("Channels", "Control"))
+		settings->channels[NET_CHANNEL_CONTROL] = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Channels", "State"))
+		settings->channels[NET_CHANNEL_STATE] = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Channels", "Bulk"))
+		settings->channels[NET_CHANNEL_BULK] = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Channels", "ControlRate"))
+		settings->channelRates[NET_CHANNEL_CONTROL] = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Channels", "BulkRate"))
+		settings->channelRates[NET_CHANNEL_BULK] = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Channels", "ControlPayload"))
+		settings->controlPayload = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Simulation", "Enabled"))
+		settings->simulation = (uint8_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Simulation", "Loss"))
+		settings->simulationLoss = PARSE_FLOAT(value);
+	else if (FIELD_MATCH("Simulation", "Latency"))
+		settings->simulationLatency = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Simulation", "Jitter"))
+		settings->simulationJitter = (uint16_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Simulation", "Duplication"))
+		settings->simulationDuplication = PARSE_FLOAT(value);
+	else if (FIELD_MATCH("Simulation", "Reordering"))
+		settings->simulationReordering = PARSE_FLOAT(value);
+	else if (FIELD_MATCH("Simulation", "Bandwidth"))
+		settings->simulationBandwidth = (uint32_t)PARSE_INTEGER(value);
+	else if (FIELD_MATCH("Timing", "MaxCatchUp"))
+		settings->maxCatchUp = (uint8_t)PARSE_INTEGER(value);
+	else
+		return 0;
+
+	return 1;
+}
+
+// The host flushes one datagram per peer, kernel buffers hold that many of them for every peer so bursts aren't dropped between flushes
+inline static int socket_buffer_size(void) {
+	size_t size = (size_t)settings.socketBufferDatagrams * NET_SOCKET_DATAGRAM_SIZE;
+
+	#ifdef NETDYNAMICS_SERVER
+		size *= NET_MAX_CLIENTS;
+	#endif
+
+	if (size > INT_MAX)
+		size = INT_MAX;
+
+	return (size > NET_SOCKET_BUFFER_SIZE) ? (int)size : NET_SOCKET_BUFFER_SIZE;
+}
+
+static uint64_t checksum_callback(const ENetBuffer* buffers, int bufferCount) {
+	return enet_crc64(buffers, bufferCount);
+}
+
+// Load
+
+#ifdef NETDYNAMICS_CLIENT
+	// Client state lives in globals, so each simulated client swaps its own copy in while it's being serviced
+	typedef struct _LoadClient {
+		ENetHost* host;
+		ENetPeer* peer;
+		Entities entities;
+		Components components;
+		int32_t* snapshotHistory;
+		uint32_t* snapshotChunks;
+		uint32_t snapshotStride;
+		uint32_t snapshotSequence[NET_SNAPSHOT_HISTORY];
+		uint32_t snapshotReceived[NET_SNAPSHOT_HISTORY];
+		uint32_t snapshotTotal[NET_SNAPSHOT_HISTORY];
+		uint64_t lastLag;
+		float worstLag;
+		bool connected;
+	} LoadClient;
+
+	static LoadClient* loadClients;
+	static uint32_t loadConnected;
+
+	inline static void load_store(LoadClient* client) {
+		client->host = enetHost;
+		client->peer = enetPeer;
+		client->entities = entities;
+		client->components = components;
+		client->snapshotHistory = snapshotHistory;
+		client->snapshotChunks = snapshotChunks;
+		client->snapshotStride = snapshotStride;
+		client->lastLag = lastLag;
+		client->worstLag = worstLag;
+		client->connected = connected;
+
+		memcpy(client->snapshotSequence, snapshotSequence, sizeof(snapshotSequence));
+		memcpy(client->snapshotReceived, snapshotReceived, sizeof(snapshotReceived));
+		memcpy(client->snapshotTotal, snapshotTotal, sizeof(snapshotTotal));
+	}
+
+	inline static void load_restore(const LoadClient* client) {
+		enetHost = client->host;
+		enetPeer = client->peer;
+		entities = client->entities;
+		components = client->components;
+		snapshotHistory = client->snapshotHistory;
+		snapshotChunks = client->snapshotChunks;
+		snapshotStride = client->snapshotStride;
+		lastLag = client->lastLag;
+		worstLag = client->worstLag;
+		connected = client->connected;
+
+		memcpy(snapshotSequence, client->snapshotSequence, sizeof(snapshotSequence));
+		memcpy(snapshotReceived, client->snapshotReceived, sizeof(snapshotReceived));
+		memcpy(snapshotTotal, client->snapshotTotal, sizeof(snapshotTotal));
+	}
+
+	inline static void load_switch(uint32_t client) {
+		if (client == loadCurrent)
+			return;
+
+		load_store(&loadClients[loadCurrent]);
+		load_restore(&loadClients[client]);
+
+		loadCurrent = client;
+	}
+
+	// The first client is the regular one which is driven and rendered by the main loop
+	inline static bool load_create(const ENetAddress* address) {
+		if ((loadClients = (LoadClient*)je_calloc(settings.loadClients, sizeof(LoadClient))) == NULL)
+			return false;
+
+		bool created = true;
+
+		for (uint32_t i = 1; i < settings.loadClients && created; i++) {
+			load_switch(i);
+
+			if (!entities_reserve(NET_ENTITY_CAPACITY) || (enetHost = enet_host_create(NULL, 1, 0, 0, 0, socket_buffer_size())) == NULL || (enetPeer = enet_host_connect(enetHost, address, NET_MAX_CHANNELS, 0)) == NULL) {
+				created = false;
+
+				break;
+			}
+
+			enet_host_set_checksum_callback(enetHost, checksum_callback);
+
+			#ifdef NETDYNAMICS_COMPRESSION
+				if (settings.compression > NET_COMPRESSION_NONE && !compressor_create(enetHost))
+					created = false;
+			#endif
+		}
+
+		load_switch(0);
+
+		return created;
+	}
+
+	inline static void load_update(float deltaTime) {
+		if (loadClients == NULL)
+			return;
+
+		loadConnected = 0;
+
+		for (uint32_t i = 1; i < settings.loadClients; i++) {
+			load_switch(i);
+
+			if (enetHost == NULL)
+				continue;
+
+			ENetEvent event = { 0 };
+			bool polled = false;
+
+			while (!polled) {
+				if (enet_host_check_events(enetHost, &event) <= 0) {
+					if (enet_host_service(enetHost, &event, 0) <= 0)
+						break;
+
+					polled = true;
+				}
+
+				if (event.type == ENET_EVENT_TYPE_CONNECT) {
+					connected = true;
+
+					message_send(event.peer, NET_MESSAGE_VIEW, NULL);
+				} else if (event.type == ENET_EVENT_TYPE_DISCONNECT || event.type == ENET_EVENT_TYPE_DISCONNECT_TIMEOUT) {
+					connected = false;
+					worstLag = 0.0f;
+
+					entity_flush();
+				} else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+					metrics_received(event.packet->dataLength);
+					message_receive(event.peer, event.packet->data, event.packet->dataLength);
+					enet_packet_destroy(event.packet);
+				}
+			}
+
+			if (ENTITIES_EXIST()) {
+				if (components.samples != NULL)
+					entity_interpolate(0, entities.count, NET_MAX_ENTITY_SPEED);
+				else
+					moveKernel(0, entities.count, NET_MAX_ENTITY_SPEED, deltaTime);
+			}
+
+			if (connected)
+				loadConnected++;
+		}
+
+		load_switch(0);
+	}
+
+	inline static void load_destroy(void) {
+		if (loadClients == NULL)
+			return;
+
+		for (uint32_t i = 1; i < settings.loadClients; i++) {
+			load_switch(i);
+
+			if (enetHost != NULL) {
+				if (enetPeer != NULL)
+					enet_peer_disconnect_now(enetPeer, 0);
+
+				enet_host_flush(enetHost);
+				enet_host_destroy(enetHost);
+			}
+
+			entities_destroy();
+			je_free(snapshotHistory);
+			je_free(snapshotChunks);
+		}
+
+		load_switch(0);
+		je_free(loadClients);
+
+		loadClients = NULL;
+	}
+#endif
+
+// Replication
+
+#ifdef NETDYNAMICS_SERVER
+	typedef struct _ReplicationQueue {
+		Entity* handles;
+		uint32_t count;
+		uint32_t capacity;
+	} ReplicationQueue;
+
+	static ReplicationQueue replicationSpawned;
+	static ReplicationQueue replicationDestroyed;
+	static ReplicationQueue replicationStreamed[NET_MAX_CLIENTS]; // Destroys of entities already streamed to a joining client
+
+	inline static void replication_queue(ReplicationQueue* queue, Entity handle) {
+		if (queue->count == queue->capacity) {
+			uint32_t capacity = (queue->capacity > 0) ? queue->capacity * 2 : NET_MAX_ENTITY_SPAWN * 4;
+			Entity* handles = (Entity*)je_realloc(queue->handles, sizeof(Entity) * capacity);
+
+			if (handles == NULL)
+				return;
+
+			queue->handles = handles;
+			queue->capacity = capacity;
+		}
+
+		queue->handles[queue->count++] = handle;
+	}
+
+	inline static void replication_spawned(void) {
+		if (connected == 0)
+			return;
+
+		for (uint32_t i = entities.count - entities.spawned; i < entities.count; i++) {
+			replication_queue(&replicationSpawned, entities.dense[i]);
+		}
+	}
+
+	inline static int replication_compare(const void* a, const void* b) {
+		Entity left = *(const Entity*)a, right = *(const Entity*)b;
+
+		return (left > right) - (left < right);
+	}
+
+	// Entities destroyed within the same tick are skipped, their destroy still follows and is ignored by the client
+	inline static void replication_flush_spawned(void) {
+		ReplicationQueue* queue = &replicationSpawned;
+		uint32_t capacity = (settings.controlPayload - PACKED_BATCH_ENTRIES - settings.redundantBytes) / PACKED_SPAWN_BATCH_ENTRY_SIZE;
+
+		for (uint32_t i = 0; i < queue->count;) {
+			uint32_t entries = 0;
+
+			if (settings.serializer == NET_SERIALIZER_PACKED) {
+				uint8_t* buffer = packet_allocate(settings.controlPayload);
+				uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+				for (; i < queue->count && entries < capacity; i++) {
+					uint32_t slot = entity_slot(queue->handles[i]);
+
+					if (slot == ENTITY_NONE)
+						continue;
+
+					message_pack_spawn_entry(entry, slot);
+
+					entry += PACKED_SPAWN_BATCH_ENTRY_SIZE;
+					entries++;
+				}
+
+				if (entries > 0) {
+					packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_SPAWN_BATCH);
+					packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+					packet_submit_to_all(buffer, packed_write_redundancy(buffer, PACKED_BATCH_ENTRIES + entries * PACKED_SPAWN_BATCH_ENTRY_SIZE), NET_CHANNEL_CONTROL);
+				} else {
+					packet_release(buffer);
+				}
+
+				continue;
+			}
+
+			binn* data = binn_list();
+
+			binn_list_add_uint8(data, NET_MESSAGE_SPAWN_BATCH);
+
+			for (; i < queue->count && (entries == 0 || binn_size(data) + SPAWN_ENTRY_SIZE + settings.redundantBytes <= settings.controlPayload); i++) {
+				uint32_t slot = entity_slot(queue->handles[i]);
+
+				if (slot == ENTITY_NONE)
+					continue;
+
+				message_add_spawn_entry(data, slot);
+
+				entries++;
+			}
+
+			if (entries > 0) {
+				if (settings.redundantBytes > 0)
+					binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+				packet_send_to_all(binn_ptr(data), binn_size(data), NET_CHANNEL_CONTROL);
+			}
+
+			binn_free(data);
+		}
+
+		queue->count = 0;
+	}
+
+	// Handles are sorted so that runs of consecutive indices with the same generation collapse into a range, a null client broadcasts
+	inline static void replication_flush_destroyed(ReplicationQueue* queue, void* client, uint8_t channel, uint32_t size) {
+		uint32_t capacity = (size - PACKED_BATCH_ENTRIES - settings.redundantBytes) / PACKED_DESTROY_RANGE_SIZE;
+
+		qsort(queue->handles, queue->count, sizeof(Entity), replication_compare);
+
+		for (uint32_t i = 0; i < queue->count;) {
+			uint32_t entries = 0;
+			uint8_t* buffer = NULL;
+			binn* data = NULL;
+
+			if (settings.serializer == NET_SERIALIZER_PACKED)
+				buffer = packet_allocate(size);
+			else
+				data = binn_list();
+
+			if (data != NULL)
+				binn_list_add_uint8(data, NET_MESSAGE_DESTROY_RANGE);
+
+			while (i < queue->count) {
+				if (buffer != NULL && entries == capacity)
+					break;
+
+				if (data != NULL && entries > 0 && binn_size(data) + DESTROY_RANGE_ENTRY_SIZE + settings.redundantBytes > size)
+					break;
+
+				Entity first = queue->handles[i];
+				uint32_t count = 1;
+
+				for (i++; i < queue->count && count < UINT16_MAX; i++) {
+					if (queue->handles[i] == first + count - 1)
+						continue;
+
+					if (queue->handles[i] != first + count || ENTITY_INDEX(first + count) == 0)
+						break;
+
+					count++;
+				}
+
+				if (buffer != NULL) {
+					uint8_t* entry = buffer + PACKED_BATCH_ENTRIES + entries * PACKED_DESTROY_RANGE_SIZE;
+
+					packed_write_uint32(entry, PACKED_DESTROY_RANGE_FIRST, first);
+					packed_write_uint16(entry, PACKED_DESTROY_RANGE_COUNT, (uint16_t)count);
+				} else {
+					binn_list_add_uint32(data, first);
+					binn_list_add_uint32(data, count);
+				}
+
+				entries++;
+			}
+
+			if (buffer != NULL) {
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_DESTROY_RANGE);
+				packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+				size_t length = packed_write_redundancy(buffer, PACKED_BATCH_ENTRIES + entries * PACKED_DESTROY_RANGE_SIZE);
+
+				if (client != NULL)
+					packet_submit(client, buffer, length, channel);
+				else
+					packet_submit_to_all(buffer, length, channel);
+			} else {
+				if (settings.redundantBytes > 0)
+					binn_list_add_blob(data, redundancyBuffer, settings.redundantBytes);
+
+				if (client != NULL)
+					packet_send(client, binn_ptr(data), binn_size(data), channel);
+				else
+					packet_send_to_all(binn_ptr(data), binn_size(data), channel);
+
+				binn_free(data);
+			}
+		}
+
+		queue->count = 0;
+	}
+
+	// Spawns and destroys of a tick go out together as reliable batches, destroys first since their indices may be reused by the spawns
+	inline static void replication_flush(void) {
+		// Channels aren't ordered with each other, so destroys that raced the stream are repeated behind it on the bulk channel
+		for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+			if (replicationStreamed[i].count == 0 || streams[i].active)
+				continue;
+
+			if (clients[i] != NULL)
+				replication_flush_destroyed(&replicationStreamed[i], clients[i], NET_CHANNEL_BULK, settings.streamChunkSize);
+
+			replicationStreamed[i].count = 0;
+		}
+
+		if (replicationSpawned.count == 0 && replicationDestroyed.count == 0)
+			return;
+
+		if (connected > 0) {
+			transport->flush();
+
+			if (replicationDestroyed.count > 0)
+				replication_flush_destroyed(&replicationDestroyed, NULL, NET_CHANNEL_CONTROL, settings.controlPayload);
+
+			if (replicationSpawned.count > 0)
+				replication_flush_spawned();
+		}
+
+		replicationSpawned.count = 0;
+		replicationDestroyed.count = 0;
+	}
+
+	inline static void replication_destroy(void) {
+		je_free(replicationSpawned.handles);
+		je_free(replicationDestroyed.handles);
+
+		memset(&replicationSpawned, 0, sizeof(replicationSpawned));
+		memset(&replicationDestroyed, 0, sizeof(replicationDestroyed));
+
+		for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+			je_free(replicationStreamed[i].handles);
+		}
+
+		memset(replicationStreamed, 0, sizeof(replicationStreamed));
+	}
+
+	inline static void world_spawn(Vector2 positionComponent, uint32_t quantity) {
+		entity_spawn(positionComponent, quantity);
+		replication_spawned();
+	}
+
+	inline static void world_destroy(uint32_t quantity) {
+		for (; quantity > 0 && ENTITIES_EXIST(); quantity--) {
+			Entity destroyed = entities.dense[entities.count - 1];
+
+			entity_destroy(destroyed);
+
+			if (connected == 0)
+				continue;
+
+			replication_queue(&replicationDestroyed, destroyed);
+
+			for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+				if (streams[i].active && ENTITY_INDEX(destroyed) < streams[i].cursor)
+					replication_queue(&replicationStreamed[i], destroyed);
+			}
+		}
+	}
+#endif
+
+// Scenario
+
+#ifdef NETDYNAMICS_SERVER
+	#define SCENARIO_UNSET UINT32_MAX
+
+	typedef struct _ScenarioStep {
+		float time;
+		uint32_t spawn;
+		uint32_t destroy;
+		uint32_t target;
+		uint32_t sendRate;
+		float x;
+		float y;
+		uint32_t order; // Position in the file, so steps with equal time keep it after sorting
+	} ScenarioStep;
+
+	typedef struct _Scenario {
+		ScenarioStep* steps;
+		uint32_t count;
+		uint32_t capacity;
+		uint32_t next;
+		uint64_t seed;
+		float duration;
+		float time;
+		bool active;
+		char section[64];
+		uint32_t frames;
+		float worstFrameTime;
+		uint32_t peakEntities;
+	} Scenario;
+
+	static Scenario scenario;
+
+	inline static ScenarioStep* scenario_step(const char* section) {
+		if (scenario.count == 0 || strcmp(scenario.section, section) != 0) {
+			if (scenario.count == scenario.capacity) {
+				uint32_t capacity = (scenario.capacity > 0) ? scenario.capacity * 2 : 16;
+				ScenarioStep* steps = (ScenarioStep*)je_realloc(scenario.steps, sizeof(ScenarioStep) * capacity);
+
+				if (steps == NULL)
+					return NULL;
+
+				scenario.steps = steps;
+				scenario.capacity = capacity;
+			}
+
+			scenario.steps[scenario.count] = (ScenarioStep){ 0.0f, 0, 0, SCENARIO_UNSET, SCENARIO_UNSET, -1.0f, -1.0f, scenario.count };
+			scenario.count++;
+
+			strncpy(scenario.section, section, sizeof(scenario.section) - 1);
+		}
+
+		return &scenario.steps[scenario.count - 1];
+	}
+
+	// Every section other than [Scenario] is a step of the timeline, the names only have to differ from the previous one
+	static int scenario_callback(void* data, const char* section, const char* name, const char* value) {
+		#define STEP_MATCH(n) strcmp(name, n) == 0
+
+		if (strcmp(section, "Scenario") == 0) {
+			if (STEP_MATCH("Seed"))
+				scenario.seed = strtoull(value, NULL, 10);
+			else if (STEP_MATCH("Duration"))
+				scenario.duration = strtof(value, NULL);
+			else
+				return 0;
+
+			return 1;
+		}
+
+		ScenarioStep* step = scenario_step(section);
+
+		if (step == NULL)
+			return 0;
+
+		if (STEP_MATCH("Time"))
+			step->time = strtof(value, NULL);
+		else if (STEP_MATCH("Spawn"))
+			step->spawn = (uint32_t)PARSE_INTEGER(value);
+		else if (STEP_MATCH("Destroy"))
+			step->destroy = (uint32_t)PARSE_INTEGER(value);
+		else if (STEP_MATCH("Target"))
+			step->target = (uint32_t)PARSE_INTEGER(value);
+		else if (STEP_MATCH("SendRate"))
+			step->sendRate = (uint32_t)PARSE_INTEGER(value);
+		else if (STEP_MATCH("X"))
+			step->x = strtof(value, NULL);
+		else if (STEP_MATCH("Y"))
+			step->y = strtof(value, NULL);
+		else
+			return 0;
+
+		return 1;
+	}
+
+	static int scenario_compare(const void* left, const void* right) {
+		const ScenarioStep* a = (const ScenarioStep*)left;
+		const ScenarioStep* b = (const ScenarioStep*)right;
+
+		if (a->time != b->time)
+			return (a->time > b->time) - (a->time < b->time);
+
+		return (a->order > b->order) - (a->order < b->order);
+	}
+
+	inline static bool scenario_load(const char* path) {
+		if (ini_parse(path, scenario_callback, &scenario) != 0)
+			return false;
+
+		// Steps with equal time run in the same frame, but their order still changes the counts and the random positions
+		qsort(scenario.steps, scenario.count, sizeof(ScenarioStep), scenario_compare);
+		random_seed(scenario.seed);
+
+		scenario.active = true;
+
+		return true;
+	}
+
+	inline static Vector2 scenario_position(const ScenarioStep* step) {
+		Vector2 position = { step->x, step->y };
+
+		if (position.x < 0.0f)
+			position.x = (float)random_range(0, settings.resolutionWidth - textureWidth);
+
+		if (position.y < 0.0f)
+			position.y = (float)random_range(0, settings.resolutionHeight - textureHeight);
+
+		return position;
+	}
+
+	inline static void scenario_apply(const ScenarioStep* step) {
+		if (step->sendRate != SCENARIO_UNSET && step->sendRate > 0)
+			settings.sendRate = (uint8_t)((step->sendRate > UINT8_MAX) ? UINT8_MAX : step->sendRate);
+
+		for (uint32_t spawned = 0; spawned < step->spawn; spawned += NET_MAX_ENTITY_SPAWN) {
+			world_spawn(scenario_position(step), (step->spawn - spawned < NET_MAX_ENTITY_SPAWN) ? step->spawn - spawned : NET_MAX_ENTITY_SPAWN);
+		}
+
+		world_destroy(step->destroy);
+
+		if (step->target != SCENARIO_UNSET) {
+			while (entities.count < step->target) {
+				uint32_t count = entities.count;
+
+				world_spawn(scenario_position(step), (step->target - entities.count < NET_MAX_ENTITY_SPAWN) ? step->target - entities.count : NET_MAX_ENTITY_SPAWN);
+
+				if (entities.count == count)
+					break;
+			}
+
+			if (entities.count > step->target)
+				world_destroy(entities.count - step->target);
+		}
+	}
+
+	// Returns false once the run is over
+	inline static bool scenario_update(float deltaTime) {
+		if (!scenario.active)
+			return true;
+
+		scenario.time += deltaTime;
+		scenario.frames++;
+
+		if (scenario.worstFrameTime < deltaTime)
+			scenario.worstFrameTime = deltaTime;
+
+		while (scenario.next < scenario.count && scenario.steps[scenario.next].time <= scenario.time) {
+			scenario_apply(&scenario.steps[scenario.next++]);
+		}
+
+		if (scenario.peakEntities < entities.count)
+			scenario.peakEntities = entities.count;
+
+		return scenario.duration <= 0.0f || scenario.time < scenario.duration;
+	}
+
+	inline static void scenario_report(void) {
+		if (!scenario.active)
+			return;
+
+		float time = (scenario.time > 0.0f) ? scenario.time : 1.0f;
+		FILE* stream = report_stream();
+
+		fprintf(stream, "SCENARIO %s\n", transport->name);
+		fprintf(stream, "Seed %llu\n", (unsigned long long)scenario.seed);
+		fprintf(stream, "Duration %.3f s\n", scenario.time);
+		fprintf(stream, "Frames %u\n", scenario.frames);
+		fprintf(stream, "Average frame time %.3f ms\n", (scenario.frames > 0) ? (scenario.time / scenario.frames) * 1000.0f : 0.0f);
+		fprintf(stream, "Worst frame time %.3f ms\n", scenario.worstFrameTime * 1000.0f);
+		fprintf(stream, "Entities %u (peak %u)\n", entities.count, scenario.peakEntities);
+		fprintf(stream, "Messages sent %llu (%.1f per second)\n", (unsigned long long)metrics.totalMessagesSent, metrics.totalMessagesSent / time);
+		fprintf(stream, "Messages received %llu (%.1f per second)\n", (unsigned long long)metrics.totalMessagesReceived, metrics.totalMessagesReceived / time);
+		fprintf(stream, "Bytes sent %llu (%.1f per second)\n", (unsigned long long)metrics.totalBytesSent, metrics.totalBytesSent / time);
+		fprintf(stream, "Bytes received %llu (%.1f per second)\n", (unsigned long long)metrics.totalBytesReceived, metrics.totalBytesReceived / time);
+		fflush(stream);
+	}
+
+	inline static void scenario_destroy(void) {
+		je_free(scenario.steps);
+
+		scenario.steps = NULL;
+	}
+#endif
+
+// Transports
+
+static const char* enet_initialize(void) {
+	ENetCallbacks callbacks = {
+		je_malloc,
+		je_free,
+		abort
+	};
+
+	if (enet_initialize_with_callbacks(enet_linked_version(), &callbacks) < 0)
+		return "ENet initialization failed";
+
+	return NULL;
+}
+
+static const char* enet_connect(void) {
+	ENetAddress address = { 0 };
+
+	address.port = settings.port;
+
+	#ifdef NETDYNAMICS_SERVER
+		if ((enetHost = enet_host_create(&address, NET_MAX_CLIENTS, NET_MAX_CHANNELS, 0, 0, socket_buffer_size())) == NULL)
+			return string_host_failed;
+
+		status = string_listening;
+	#elif NETDYNAMICS_CLIENT
+		if (enet_address_set_hostname(&address, settings.ip) < 0)
+			return string_address_failed;
+
+		if ((enetHost = enet_host_create(NULL, 1, 0, 0, 0, socket_buffer_size())) == NULL)
+			return string_host_failed;
+
+		if ((enetPeer = enet_host_connect(enetHost, &address, NET_MAX_CHANNELS, 0)) == NULL)
+			return string_connection_failed;
+
+		status = string_connecting;
+	#endif
+
+	enet_host_set_checksum_callback(enetHost, checksum_callback);
+
+	#ifdef NETDYNAMICS_COMPRESSION
+		if (settings.compression > NET_COMPRESSION_NONE && !compressor_create(enetHost))
+			return "Compressor creation failed";
+	#endif
+
+	#ifdef NETDYNAMICS_CLIENT
+		if (settings.loadClients > 1 && !load_create(&address))
+			return "Load clients creation failed";
+	#endif
+
+	if (settings.networkThread > 0 && !network_thread_start())
+		return "Network thread creation failed";
+
+	return NULL;
+}
+
+// Services the host at most once per frame, events queued by the service call are picked up on the next frame
+static bool enet_poll(TransportEvent* transportEvent) {
+	static ENetEvent event = { 0 };
+	static bool serviced = false;
+
+	do {
+		if (settings.networkThread > 0) {
+			if (!ring_pop(&networkInbound, &event))
+				return false;
+		} else if (serviced || enet_host_check_events(enetHost, &event) <= 0) {
+			if (serviced || enet_host_service(enetHost, &event, 0) <= 0) {
+				serviced = false;
+
+				return false;
+			}
+
+			serviced = true;
+		}
+	} while (event.type == ENET_EVENT_TYPE_NONE);
+
+	transportEvent->peer = event.peer;
+	transportEvent->peerID = event.peer->incomingPeerID;
+	transportEvent->data = NULL;
+	transportEvent->length = 0;
+	transportEvent->packet = NULL;
+	transportEvent->reliable = true;
+
+	switch (event.type) {
+		case ENET_EVENT_TYPE_CONNECT:
+			transportEvent->type = TRANSPORT_EVENT_CONNECT;
+
+			break;
+
+		case ENET_EVENT_TYPE_RECEIVE:
+			transportEvent->type = TRANSPORT_EVENT_RECEIVE;
+			transportEvent->data = event.packet->data;
+			transportEvent->length = event.packet->dataLength;
+			transportEvent->packet = event.packet;
+			transportEvent->reliable = (event.packet->flags & ENET_PACKET_FLAG_RELIABLE) != 0;
+
+			break;
+
+		default:
+			transportEvent->type = TRANSPORT_EVENT_DISCONNECT;
+
+			break;
+	}
+
+	return true;
+}
+
+static void enet_release(TransportEvent* event) {
+	if (event->packet != NULL)
+		enet_packet_destroy((ENetPacket*)event->packet);
+}
+
+static void enet_send(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	ENetPacket* packet = packet_wrap(data, length, reliable);
+
+	if (peer == NULL)
+		peer = enetPeer;
+
+	if (settings.networkThread > 0)
+		network_enqueue((ENetPeer*)peer, packet, channel);
+	else if (enet_peer_send((ENetPeer*)peer, channel, packet) < 0)
+		enet_packet_destroy(packet);
+}
+
+static void enet_broadcast(uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	ENetPacket* packet = packet_wrap(data, length, reliable);
+
+	if (settings.networkThread > 0)
+		network_enqueue(NULL, packet, channel);
+	else
+		enet_host_broadcast(enetHost, channel, packet);
+}
+
+static uint32_t enet_identify(void* peer) {
+	return ((ENetPeer*)peer)->incomingPeerID;
+}
+
+static uint32_t enet_connections(void) {
+	if (settings.networkThread > 0) {
+		aws_mutex_lock(&networkSnapshot.mutex);
+
+		uint32_t connected = (uint32_t)networkSnapshot.connected;
+
+		aws_mutex_unlock(&networkSnapshot.mutex);
+
+		return connected;
+	}
+
+	return (enetHost != NULL) ? enetHost->connectedPeers : 0;
+}
+
+static bool enet_stats(void* peer, TransportStats* stats) {
+	ENetPeer* enetTarget = (peer != NULL) ? (ENetPeer*)peer : enetPeer;
+
+	if (enetTarget == NULL)
+		return false;
+
+	if (settings.networkThread > 0) {
+		uint32_t id = enetTarget->incomingPeerID;
+
+		if (id >= networkSnapshot.peerCount)
+			return false;
+
+		aws_mutex_lock(&networkSnapshot.mutex);
+
+		*stats = networkSnapshot.peers[id];
+
+		aws_mutex_unlock(&networkSnapshot.mutex);
+
+		return true;
+	}
+
+	network_peer_stats(enetTarget, stats);
+
+	return true;
+}
+
+static void enet_shutdown(void) {
+	if (settings.networkThread > 0)
+		network_thread_stop();
+
+	#ifdef NETDYNAMICS_CLIENT
+		load_destroy();
+	#endif
+
+	if (enetHost != NULL) {
+		#ifdef NETDYNAMICS_SERVER
+			for (uint32_t i = 0; i < enetHost->peerCount; i++) {
+				enet_peer_disconnect_now(&enetHost->peers[i], 0);
+			}
+		#elif NETDYNAMICS_CLIENT
+			if (enetPeer != NULL)
+				enet_peer_disconnect_now(enetPeer, 0);
+		#endif
+
+		enet_host_flush(enetHost);
+		enet_host_destroy(enetHost);
+
+		enetHost = NULL;
+	}
+
+	enet_deinitialize();
+}
+
+// HyperNet is a proprietary library, builds without it get a backend that refuses to start
+
+static const char* hypernet_initialize(void) {
+	return "HyperNet is not available in this build";
+}
+
+static const char* hypernet_connect(void) {
+	return NULL;
+}
+
+static bool hypernet_poll(TransportEvent* event) {
+	return false;
+}
+
+static void hypernet_release(TransportEvent* event) {
+
+}
+
+static void hypernet_send(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void hypernet_broadcast(uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void hypernet_flush(void) {
+
+}
+
+static uint32_t hypernet_identify(void* peer) {
+	return 0;
+}
+
+static uint32_t hypernet_connections(void) {
+	return 0;
+}
+
+static bool hypernet_stats(void* peer, TransportStats* stats) {
+	return false;
+}
+
+static void hypernet_shutdown(void) {
+
+}
+
+// Replay feeds a capture back as received events, bursts of records close in time make one frame
+
+typedef struct _Replay {
+	MappedFile log;
+	size_t offset;
+	uint64_t burstTime;
+	bool bursting;
+	bool finished;
+	uint32_t connected;
+	uint64_t events;
+	uint64_t bytes;
+	uint64_t startTime;
+} Replay;
+
+static Replay replay;
+static uint8_t replayPeers[NET_MAX_CLIENTS];
+
+static const char* replay_initialize(void) {
+	if (settings.replay == NULL || !mapped_file_open(&replay.log, settings.replay, 0, false))
+		return "Replay file opening failed";
+
+	CaptureHeader header;
+
+	if (replay.log.size < sizeof(header))
+		return "Replay file is not a capture";
+
+	memcpy(&header, replay.log.memory, sizeof(header));
+
+	if (header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION)
+		return "Replay file is not a capture";
+
+	if (header.flavor != CAPTURE_FLAVOR)
+		return "Replay file was captured by the other side";
+
+	replay.offset = sizeof(header);
+
+	return NULL;
+}
+
+static const char* replay_connect(void) {
+	status = "Replaying capture";
+
+	aws_high_res_clock_get_ticks(&replay.startTime);
+
+	return NULL;
+}
+
+static bool replay_poll(TransportEvent* event) {
+	CaptureRecord record;
+
+	while (true) {
+		if (replay.offset + sizeof(record) > replay.log.size) {
+			replay.finished = true;
+
+			return false;
+		}
+
+		memcpy(&record, replay.log.memory + replay.offset, sizeof(record));
+
+		if (replay.offset + sizeof(record) + record.length > replay.log.size) {
+			replay.finished = true;
+
+			return false;
+		}
+
+		if (record.type == CAPTURE_EVENT_SEND || record.peer >= NET_MAX_CLIENTS) {
+			replay.offset += sizeof(record) + record.length;
+
+			continue;
+		}
+
+		break;
+	}
+
+	if (replay.bursting && record.time - replay.burstTime > NET_REPLAY_BURST) {
+		replay.bursting = false;
+
+		return false;
+	}
+
+	if (!replay.bursting) {
+		replay.bursting = true;
+		replay.burstTime = record.time;
+	}
+
+	event->type = record.type;
+	event->peer = &replayPeers[record.peer];
+	event->peerID = record.peer;
+	event->data = replay.log.memory + replay.offset + sizeof(record);
+	event->length = record.length;
+	event->packet = NULL;
+	event->reliable = record.type != TRANSPORT_EVENT_RECEIVE || record.reliable != 0;
+
+	if (record.type == TRANSPORT_EVENT_CONNECT)
+		replay.connected++;
+	else if (record.type == TRANSPORT_EVENT_DISCONNECT && replay.connected > 0)
+		replay.connected--;
+
+	replay.offset += sizeof(record) + record.length;
+	replay.events++;
+	replay.bytes += record.length;
+
+	return true;
+}
+
+static void replay_release(TransportEvent* event) {
+
+}
+
+static void replay_send(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void replay_broadcast(uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void replay_flush(void) {
+
+}
+
+static uint32_t replay_identify(void* peer) {
+	return (uint32_t)((uint8_t*)peer - replayPeers);
+}
+
+static uint32_t replay_connections(void) {
+	return replay.connected;
+}
+
+static bool replay_stats(void* peer, TransportStats* stats) {
+	return false;
+}
+
+static void replay_shutdown(void) {
+	if (replay.startTime > 0) {
+		uint64_t currentTime = 0;
+
+		aws_high_res_clock_get_ticks(&currentTime);
+
+		double time = (currentTime - replay.startTime) / 1000000000.0;
+
+		if (time <= 0.0)
+			time = 1.0;
+
+		FILE* stream = report_stream();
+
+		fprintf(stream, "REPLAY %s\n", settings.replay);
+		fprintf(stream, "Events %llu (%.1f per second)\n", (unsigned long long)replay.events, replay.events / time);
+		fprintf(stream, "Bytes %llu (%.1f MB per second)\n", (unsigned long long)replay.bytes, replay.bytes / time / (1024.0 * 1024.0));
+		fprintf(stream, "Duration %.3f s\n", time);
+		fflush(stream);
+	}
+
+	mapped_file_close(&replay.log, 0, false);
+}
+
+// The null backend discards everything, it's used to measure the systems without a network
+
+static const char* null_initialize(void) {
+	return NULL;
+}
+
+static const char* null_connect(void) {
+	return NULL;
+}
+
+static bool null_poll(TransportEvent* event) {
+	return false;
+}
+
+static void null_release(TransportEvent* event) {
+
+}
+
+static void null_send(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void null_broadcast(uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	packet_release(data);
+}
+
+static void null_flush(void) {
+
+}
+
+static uint32_t null_identify(void* peer) {
+	return 0;
+}
+
+static uint32_t null_connections(void) {
+	return 0;
+}
+
+static bool null_stats(void* peer, TransportStats* stats) {
+	return false;
+}
+
+static void null_shutdown(void) {
+
+}
+
+static const Transport transports[] = {
+	{
+		"HyperNet",
+		hypernet_initialize,
+		hypernet_connect,
+		hypernet_poll,
+		hypernet_release,
+		hypernet_send,
+		hypernet_broadcast,
+		hypernet_flush,
+		hypernet_identify,
+		hypernet_connections,
+		hypernet_stats,
+		hypernet_shutdown
+	},
+	{
+		"ENet",
+		enet_initialize,
+		enet_connect,
+		enet_poll,
+		enet_release,
+		enet_send,
+		enet_broadcast,
+		network_flush,
+		enet_identify,
+		enet_connections,
+		enet_stats,
+		enet_shutdown
+	},
+	{
+		"Replay",
+		replay_initialize,
+		replay_connect,
+		replay_poll,
+		replay_release,
+		replay_send,
+		replay_broadcast,
+		replay_flush,
+		replay_identify,
+		replay_connections,
+		replay_stats,
+		replay_shutdown
+	},
+	{
+		"Null",
+		null_initialize,
+		null_connect,
+		null_poll,
+		null_release,
+		null_send,
+		null_broadcast,
+		null_flush,
+		null_identify,
+		null_connections,
+		null_stats,
+		null_shutdown
+	}
+};
+
+// Conditioning
+
+#define CONDITIONER_OUTBOUND 0
+#define CONDITIONER_INBOUND 1
+#define CONDITIONER_NONE UINT32_MAX
+
+typedef struct _ConditionerEntry {
+	uint64_t due;
+	TransportEvent event;
+	uint8_t direction;
+	uint8_t channel;
+	bool reliable;
+	bool broadcast;
+	uint32_t next;
+} ConditionerEntry;
+
+typedef struct _ConditionerBucket {
+	uint64_t time;
+	double tokens;
+} ConditionerBucket;
+
+// Delayed messages sit in a wheel of millisecond slots, those due beyond one turn stay in their slot until it comes around again
+typedef struct _Conditioner {
+	const Transport* inner;
+	ConditionerEntry* entries;
+	uint32_t capacity;
+	uint32_t freeList;
+	uint32_t heads[NET_SIMULATION_WHEEL_SLOTS];
+	uint32_t tails[NET_SIMULATION_WHEEL_SLOTS];
+	uint32_t readyHead;
+	uint32_t readyTail;
+	uint64_t cursor;
+	uint64_t reliableDue[2];
+	uint64_t latestDue[2];
+	uint64_t barrierDue[2];
+	ConditionerBucket buckets[2];
+	uint64_t random;
+	bool polled;
+	uint32_t dropped;
+	uint32_t duplicated;
+	char name[64];
+} Conditioner;
+
+static Conditioner conditioner;
+static uint8_t conditionerCopy; // Marks events whose data is a duplicate owned by the conditioner
+
+inline static uint64_t conditioner_time(void) {
+	uint64_t ticks = 0;
+
+	aws_high_res_clock_get_ticks(&ticks);
+
+	return ticks;
+}
+
+inline static bool conditioner_chance(float percent) {
+	return percent > 0.0f && (random_step(&conditioner.random) % 10000) < (uint32_t)(percent * 100.0f);
+}
+
+inline static uint32_t conditioner_acquire(void) {
+	if (conditioner.freeList == CONDITIONER_NONE) {
+		uint32_t capacity = (conditioner.capacity > 0) ? conditioner.capacity * 2 : NET_SIMULATION_ENTRIES;
+		ConditionerEntry* entries = (ConditionerEntry*)je_realloc(conditioner.entries, sizeof(ConditionerEntry) * capacity);
+
+		if (entries == NULL)
+			return CONDITIONER_NONE;
+
+		for (uint32_t i = conditioner.capacity; i < capacity; i++) {
+			entries[i].next = (i + 1 < capacity) ? i + 1 : CONDITIONER_NONE;
+		}
+
+		conditioner.entries = entries;
+		conditioner.freeList = conditioner.capacity;
+		conditioner.capacity = capacity;
+	}
+
+	uint32_t index = conditioner.freeList;
+
+	conditioner.freeList = conditioner.entries[index].next;
+	conditioner.entries[index].next = CONDITIONER_NONE;
+
+	return index;
+}
+
+inline static void conditioner_free(uint32_t index) {
+	conditioner.entries[index].next = conditioner.freeList;
+	conditioner.freeList = index;
+}
+
+inline static void conditioner_append(uint32_t* head, uint32_t* tail, uint32_t index) {
+	if (*head == CONDITIONER_NONE)
+		*head = index;
+	else
+		conditioner.entries[*tail].next = index;
+
+	*tail = index;
+}
+
+// Token bucket in bytes, a message that doesn't fit waits until enough has been replenished
+inline static uint64_t conditioner_shape(uint8_t direction, uint64_t due, size_t length) {
+	if (settings.simulationBandwidth == 0)
+		return due;
+
+	ConditionerBucket* bucket = &conditioner.buckets[direction];
+	double rate = settings.simulationBandwidth * 1000.0 / 8.0 / 1000000000.0;
+	double burst = settings.simulationBandwidth * 1000.0 / 8.0 * NET_SIMULATION_BURST / 1000.0;
+
+	if (due > bucket->time) {
+		bucket->tokens += (due - bucket->time) * rate;
+		bucket->time = due;
+
+		if (bucket->tokens > burst)
+			bucket->tokens = burst;
+	}
+
+	if (bucket->tokens >= length) {
+		bucket->tokens -= length;
+
+		return (bucket->time > due) ? bucket->time : due;
+	}
+
+	bucket->time += (uint64_t)((length - bucket->tokens) / rate);
+	bucket->tokens = 0.0;
+
+	return bucket->time;
+}
+
+// Reliable messages are never lost, duplicated or reordered, they are only delayed and shaped
+inline static bool conditioner_schedule(uint8_t direction, const TransportEvent* event, uint8_t channel, bool reliable, bool broadcast) {
+	uint64_t currentTime = conditioner_time();
+
+	if (!reliable && conditioner_chance(settings.simulationLoss)) {
+		conditioner.dropped++;
+
+		return false;
+	}
+
+	uint64_t due = currentTime + (uint64_t)settings.simulationLatency * 1000000;
+
+	if (settings.simulationJitter > 0)
+		due += (uint64_t)(random_step(&conditioner.random) % ((uint32_t)settings.simulationJitter * 1000 + 1)) * 1000;
+
+	if (!reliable && conditioner_chance(settings.simulationReordering))
+		due += ((uint64_t)settings.simulationJitter + NET_SIMULATION_REORDER_DELAY) * 1000000;
+
+	due = conditioner_shape(direction, due, event->length);
+
+	// Connections act as barriers so that no message overtakes them in either direction
+	if (direction == CONDITIONER_INBOUND && event->type != TRANSPORT_EVENT_RECEIVE) {
+		if (due < conditioner.latestDue[direction])
+			due = conditioner.latestDue[direction];
+
+		conditioner.barrierDue[direction] = due;
+	} else if (due < conditioner.barrierDue[direction]) {
+		due = conditioner.barrierDue[direction];
+	}
+
+	if (reliable) {
+		if (due < conditioner.reliableDue[direction])
+			due = conditioner.reliableDue[direction];
+
+		conditioner.reliableDue[direction] = due;
+	} else if (due - currentTime > (uint64_t)NET_SIMULATION_MAX_QUEUE * 1000000) {
+		conditioner.dropped++;
+
+		return false;
+	}
+
+	uint32_t index = conditioner_acquire();
+
+	if (index == CONDITIONER_NONE)
+		return false;
+
+	if (due > conditioner.latestDue[direction])
+		conditioner.latestDue[direction] = due;
+
+	ConditionerEntry* entry = &conditioner.entries[index];
+	uint64_t slot = due / 1000000;
+
+	// Slots behind the cursor were already visited, so the entry goes to the next one
+	if (slot < conditioner.cursor)
+		slot = conditioner.cursor;
+
+	entry->due = due;
+	entry->event = *event;
+	entry->direction = direction;
+	entry->channel = channel;
+	entry->reliable = reliable;
+	entry->broadcast = broadcast;
+
+	conditioner_append(&conditioner.heads[slot % NET_SIMULATION_WHEEL_SLOTS], &conditioner.tails[slot % NET_SIMULATION_WHEEL_SLOTS], index);
+
+	return true;
+}
+
+inline static void conditioner_deliver(uint32_t index) {
+	ConditionerEntry* entry = &conditioner.entries[index];
+
+	if (entry->direction == CONDITIONER_INBOUND) {
+		entry->next = CONDITIONER_NONE;
+
+		conditioner_append(&conditioner.readyHead, &conditioner.readyTail, index);
+
+		return;
+	}
+
+	if (entry->broadcast)
+		conditioner.inner->broadcast(entry->event.data, entry->event.length, entry->channel, entry->reliable);
+	else
+		conditioner.inner->send(entry->event.peer, entry->event.data, entry->event.length, entry->channel, entry->reliable);
+
+	conditioner_free(index);
+}
+
+inline static void conditioner_advance(void) {
+	uint64_t currentTime = conditioner_time();
+	uint64_t last = currentTime / 1000000;
+
+	if (conditioner.cursor == 0)
+		conditioner.cursor = last;
+
+	// After a long stall only one turn of the wheel needs to be visited
+	if (last - conditioner.cursor >= NET_SIMULATION_WHEEL_SLOTS)
+		conditioner.cursor = last - NET_SIMULATION_WHEEL_SLOTS + 1;
+
+	for (; conditioner.cursor <= last; conditioner.cursor++) {
+		uint32_t slot = conditioner.cursor % NET_SIMULATION_WHEEL_SLOTS;
+		uint32_t index = conditioner.heads[slot];
+		uint32_t head = CONDITIONER_NONE, tail = CONDITIONER_NONE;
+
+		while (index != CONDITIONER_NONE) {
+			uint32_t next = conditioner.entries[index].next;
+
+			if (conditioner.entries[index].due <= currentTime) {
+				conditioner_deliver(index);
+			} else {
+				conditioner.entries[index].next = CONDITIONER_NONE;
+				conditioner_append(&head, &tail, index);
+			}
+
+			index = next;
+		}
+
+		conditioner.heads[slot] = head;
+		conditioner.tails[slot] = tail;
+	}
+
+	// The current slot is visited again next time, since its entries may not be due yet
+	conditioner.cursor = last;
+}
+
+static const char* conditioner_initialize(void) {
+	conditioner.freeList = CONDITIONER_NONE;
+	conditioner.readyHead = CONDITIONER_NONE;
+	conditioner.readyTail = CONDITIONER_NONE;
+	conditioner.random = conditioner_time() | 1;
+
+	for (uint32_t i = 0; i < NET_SIMULATION_WHEEL_SLOTS; i++) {
+		conditioner.heads[i] = CONDITIONER_NONE;
+		conditioner.tails[i] = CONDITIONER_NONE;
+	}
+
+	return conditioner.inner->initialize();
+}
+
+static const char* conditioner_connect(void) {
+	return conditioner.inner->connect();
+}
+
+// Events of the inner transport are drained once per frame, connections are ordered with the reliable messages
+static bool conditioner_poll(TransportEvent* event) {
+	if (!conditioner.polled) {
+		TransportEvent polled;
+
+		while (conditioner.inner->poll(&polled)) {
+			if (!conditioner_schedule(CONDITIONER_INBOUND, &polled, 0, polled.reliable, false)) {
+				conditioner.inner->release(&polled);
+
+				continue;
+			}
+
+			if (polled.type == TRANSPORT_EVENT_RECEIVE && !polled.reliable && polled.length > 0 && conditioner_chance(settings.simulationDuplication)) {
+				TransportEvent duplicate = polled;
+
+				duplicate.data = packet_allocate(polled.length);
+				duplicate.packet = &conditionerCopy;
+
+				memcpy(duplicate.data, polled.data, polled.length);
+
+				if (conditioner_schedule(CONDITIONER_INBOUND, &duplicate, 0, false, false))
+					conditioner.duplicated++;
+				else
+					packet_release(duplicate.data);
+			}
+		}
+
+		conditioner.polled = true;
+
+		conditioner_advance();
+	}
+
+	if (conditioner.readyHead == CONDITIONER_NONE) {
+		conditioner.polled = false;
+
+		return false;
+	}
+
+	uint32_t index = conditioner.readyHead;
+
+	conditioner.readyHead = conditioner.entries[index].next;
+	*event = conditioner.entries[index].event;
+
+	conditioner_free(index);
+
+	return true;
+}
+
+static void conditioner_release(TransportEvent* event) {
+	if (event->packet == &conditionerCopy)
+		packet_release(event->data);
+	else
+		conditioner.inner->release(event);
+}
+
+inline static void conditioner_submit(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable, bool broadcast) {
+	TransportEvent event = { 0, peer, 0, data, length, NULL, reliable };
+
+	if (!conditioner_schedule(CONDITIONER_OUTBOUND, &event, channel, reliable, broadcast)) {
+		packet_release(data);
+
+		return;
+	}
+
+	if (!reliable && conditioner_chance(settings.simulationDuplication)) {
+		event.data = packet_allocate(length);
+
+		memcpy(event.data, data, length);
+
+		if (conditioner_schedule(CONDITIONER_OUTBOUND, &event, channel, false, broadcast))
+			conditioner.duplicated++;
+		else
+			packet_release(event.data);
+	}
+}
+
+static void conditioner_send(void* peer, uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	conditioner_submit(peer, data, length, channel, reliable, false);
+}
+
+static void conditioner_broadcast(uint8_t* data, size_t length, uint8_t channel, bool reliable) {
+	conditioner_submit(NULL, data, length, channel, reliable, true);
+}
+
+static void conditioner_flush(void) {
+	conditioner_advance();
+	conditioner.inner->flush();
+}
+
+static uint32_t conditioner_identify(void* peer) {
+	return conditioner.inner->identify(peer);
+}
+
+static uint32_t conditioner_connections(void) {
+	return conditioner.inner->connections();
+}
+
+static bool conditioner_stats(void* peer, TransportStats* stats) {
+	return conditioner.inner->stats(peer, stats);
+}
+
+// Pending messages are dropped, buffers go back to the pool and received packets to the inner transport
+static void conditioner_shutdown(void) {
+	for (uint32_t i = 0; i < NET_SIMULATION_WHEEL_SLOTS; i++) {
+		for (uint32_t index = conditioner.heads[i]; index != CONDITIONER_NONE; index = conditioner.entries[index].next) {
+			if (conditioner.entries[index].direction == CONDITIONER_OUTBOUND)
+				packet_release(conditioner.entries[index].event.data);
+			else
+				conditioner_release(&conditioner.entries[index].event);
+		}
+	}
+
+	for (uint32_t index = conditioner.readyHead; index != CONDITIONER_NONE; index = conditioner.entries[index].next) {
+		conditioner_release(&conditioner.entries[index].event);
+	}
+
+	je_free(conditioner.entries);
+
+	conditioner.inner->shutdown();
+}
+
+static Transport conditionerTransport = {
+	NULL,
+	conditioner_initialize,
+	conditioner_connect,
+	conditioner_poll,
+	conditioner_release,
+	conditioner_send,
+	conditioner_broadcast,
+	conditioner_flush,
+	conditioner_identify,
+	conditioner_connections,
+	conditioner_stats,
+	conditioner_shutdown
+};
+
+inline static const Transport* conditioner_wrap(const Transport* inner) {
+	conditioner.inner = inner;
+
+	snprintf(conditioner.name, sizeof(conditioner.name), "%s (Simulated)", inner->name);
+
+	conditionerTransport.name = conditioner.name;
+
+	return &conditionerTransport;
+}
+
+// Benchmark
+
+#ifdef NETDYNAMICS_BENCHMARK
+	#define BENCHMARK_SIZES 3
+	#define BENCHMARK_MAX_KERNELS 4
+
+	typedef void (*BenchmarkFunction)(uint32_t count);
+
+	typedef struct _BenchmarkCase {
+		const char* name;
+		uint8_t serializer;
+		BenchmarkFunction prepare;
+		BenchmarkFunction run;
+		BenchmarkFunction reset; // Untimed before every repetition, for cases that consume the world
+	} BenchmarkCase;
+
+	typedef struct _BenchmarkKernel {
+		const char* name;
+		MoveKernel kernel;
+	} BenchmarkKernel;
+
+	typedef struct _Benchmark {
+		FILE* file;
+		uint64_t* samples;
+		PacketList packets;
+		MoveKernel kernel;
+	} Benchmark;
+
+	static const uint32_t benchmarkSizes[BENCHMARK_SIZES] = { 1000, 10000, 100000 };
+	static Benchmark benchmark;
+
+	// Entities are spread over the screen with a fixed seed, so every run measures the same world
+	inline static bool benchmark_populate(uint32_t count) {
+		random_seed(NET_BENCHMARK_SEED);
+
+		#ifdef NETDYNAMICS_SERVER
+			while (ENTITIES_EXIST()) {
+				entity_destroy(entities.dense[entities.count - 1]);
+			}
+
+			if (!entities_reserve(count))
+				return false;
+
+			entity_spawn((Vector2){ 0.0f, 0.0f }, count);
+
+			for (uint32_t i = 0; i < entities.count; i++) {
+				components.positionX[i] = (float)random_range(0, settings.resolutionWidth);
+				components.positionY[i] = (float)random_range(0, settings.resolutionHeight);
+			}
+
+			return entities.count == count;
+		#elif NETDYNAMICS_CLIENT
+			entity_flush();
+
+			if (!entities_reserve(count))
+				return false;
+
+			for (uint32_t i = 0; i < count; i++) {
+				Vector2 positionComponent = { (float)random_range(0, settings.resolutionWidth), (float)random_range(0, settings.resolutionHeight) };
+				Vector2 speedComponent = { (float)random_range(-300, 300) / 60.0f, (float)random_range(-300, 300) / 60.0f };
+
+				entity_spawn(ENTITY_HANDLE(i, 0), positionComponent, speedComponent, colors[random_range(0, sizeof(colors) / sizeof(Color) - 1)]);
+
+				components.destinationX[i] = (float)random_range(0, settings.resolutionWidth);
+				components.destinationY[i] = (float)random_range(0, settings.resolutionHeight);
+			}
+
+			return entities.count == count;
+		#endif
+	}
+
+	inline static void benchmark_move(uint32_t count) {
+		benchmark.kernel(0, count, NET_MAX_ENTITY_SPEED, 1.0f / 60.0f);
+	}
+
+	#ifdef NETDYNAMICS_SERVER
+		// Encoders broadcast into the null transport, the channel counters tell how much they produced
+
+		inline static uint64_t benchmark_bytes(void) {
+			uint64_t bytes = 0;
+
+			for (uint32_t i = 0; i < NET_CHANNELS; i++) {
+				bytes += channelCounters[i].bytes;
+				channelCounters[i].messages = 0;
+				channelCounters[i].bytes = 0;
+			}
+
+			return bytes;
+		}
+
+		inline static void benchmark_encode_spawn(uint32_t count) {
+			for (uint32_t i = 0; i < count; i++) {
+				message_send_to_all(NET_MESSAGE_SPAWN, &entities.dense[i]);
+			}
+		}
+
+		inline static void benchmark_encode_move(uint32_t count) {
+			for (uint32_t i = 0; i < count; i++) {
+				message_send_to_all(NET_MESSAGE_MOVE, &entities.dense[i]);
+			}
+		}
+
+		inline static void benchmark_encode_move_batch(uint32_t count) {
+			uint8_t positionBits = settings.positionBits;
+
+			settings.positionBits = 0;
+
+			message_send_batch_to_all(0, entities.indices);
+
+			settings.positionBits = positionBits;
+		}
+
+		inline static void benchmark_encode_move_quantized(uint32_t count) {
+			uint8_t positionBits = settings.positionBits;
+
+			if (settings.positionBits == 0)
+				settings.positionBits = 16;
+
+			message_send_batch_to_all(0, entities.indices);
+
+			settings.positionBits = positionBits;
+		}
+
+		inline static void benchmark_encode_spawn_batch(uint32_t count) {
+			for (uint32_t i = 0; i < count; i++) {
+				replication_queue(&replicationSpawned, entities.dense[i]);
+			}
+
+			replication_flush_spawned();
+		}
+
+		inline static void benchmark_encode_destroy_range(uint32_t count) {
+			for (uint32_t i = 0; i < count; i++) {
+				replication_queue(&replicationDestroyed, entities.dense[i]);
+			}
+
+			replication_flush_destroyed(&replicationDestroyed, NULL, NET_CHANNEL_CONTROL, settings.controlPayload);
+		}
+
+		// The world doesn't move between repetitions, so deltas against the previous snapshot are all zero
+		inline static void benchmark_capture(uint32_t count) {
+			if (!snapshot_reserve(entities.capacity))
+				return;
+
+			snapshot_capture();
+			snapshot++;
+		}
+
+		inline static void benchmark_encode_move_delta(uint32_t count) {
+			if (!snapshot_reserve(entities.capacity))
+				return;
+
+			snapshot_capture();
+			message_send_delta(NULL, snapshot - 1);
+			snapshot++;
+		}
+
+		inline static void benchmark_encode_move_absolute(uint32_t count) {
+			if (!snapshot_reserve(entities.capacity))
+				return;
+
+			snapshot_capture();
+			message_send_delta(NULL, 0);
+			snapshot++;
+		}
+
+		static const BenchmarkCase benchmarkCases[] = {
+			{ "encode_spawn_binn", NET_SERIALIZER_BINN, NULL, benchmark_encode_spawn, NULL },
+			{ "encode_spawn_packed", NET_SERIALIZER_PACKED, NULL, benchmark_encode_spawn, NULL },
+			{ "encode_move_binn", NET_SERIALIZER_BINN, NULL, benchmark_encode_move, NULL },
+			{ "encode_move_packed", NET_SERIALIZER_PACKED, NULL, benchmark_encode_move, NULL },
+			{ "encode_move_batch_binn", NET_SERIALIZER_BINN, NULL, benchmark_encode_move_batch, NULL },
+			{ "encode_move_batch_packed", NET_SERIALIZER_PACKED, NULL, benchmark_encode_move_batch, NULL },
+			{ "encode_move_quantized", NET_SERIALIZER_PACKED, NULL, benchmark_encode_move_quantized, NULL },
+			{ "encode_move_delta", NET_SERIALIZER_PACKED, benchmark_capture, benchmark_encode_move_delta, NULL },
+			{ "encode_move_delta_absolute", NET_SERIALIZER_PACKED, NULL, benchmark_encode_move_absolute, NULL },
+			{ "encode_spawn_batch_binn", NET_SERIALIZER_BINN, NULL, benchmark_encode_spawn_batch, NULL },
+			{ "encode_spawn_batch_packed", NET_SERIALIZER_PACKED, NULL, benchmark_encode_spawn_batch, NULL },
+			{ "encode_destroy_range_binn", NET_SERIALIZER_BINN, NULL, benchmark_encode_destroy_range, NULL },
+			{ "encode_destroy_range_packed", NET_SERIALIZER_PACKED, NULL, benchmark_encode_destroy_range, NULL }
+		};
+	#elif NETDYNAMICS_CLIENT
+		// Packets are prepared once from the populated world and decoded in place on every repetition
+
+		inline static uint64_t benchmark_bytes(void) {
+			return benchmark.packets.size;
+		}
+
+		inline static void benchmark_commit_binn(binn* data, bool stamped) {
+			uint8_t* buffer = packet_list_reserve(&benchmark.packets, binn_size(data) + PACKED_STAMP_SIZE);
+
+			if (buffer != NULL) {
+				size_t length = binn_size(data);
+
+				memcpy(buffer, binn_ptr(data), length);
+
+				if (stamped) {
+					memset(buffer + length, 0, PACKED_STAMP_SIZE);
+
+					length += PACKED_STAMP_SIZE;
+				}
+
+				packet_list_commit(&benchmark.packets, length);
+			}
+
+			binn_free(data);
+		}
+
+		inline static void benchmark_pack_spawn(uint32_t count) {
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			for (uint32_t i = 0; i < count; i++) {
+				if (settings.serializer == NET_SERIALIZER_PACKED) {
+					uint8_t* buffer = packet_list_reserve(&benchmark.packets, PACKED_SPAWN_SIZE);
+
+					if (buffer == NULL)
+						return;
+
+					packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_SPAWN);
+					packed_write_uint32(buffer, PACKED_SPAWN_ENTITY, entities.dense[i]);
+					packed_write_float(buffer, PACKED_SPAWN_POSITION_X, components.positionX[i]);
+					packed_write_float(buffer, PACKED_SPAWN_POSITION_Y, components.positionY[i]);
+					packed_write_float(buffer, PACKED_SPAWN_SPEED_X, components.speedX[i]);
+					packed_write_float(buffer, PACKED_SPAWN_SPEED_Y, components.speedY[i]);
+					packed_write_uint8(buffer, PACKED_SPAWN_COLOR_R, components.color[i].r);
+					packed_write_uint8(buffer, PACKED_SPAWN_COLOR_G, components.color[i].g);
+					packed_write_uint8(buffer, PACKED_SPAWN_COLOR_B, components.color[i].b);
+					packet_list_commit(&benchmark.packets, PACKED_SPAWN_SIZE);
+
+					continue;
+				}
+
+				binn* data = binn_list();
+
+				binn_list_add_uint8(data, NET_MESSAGE_SPAWN);
+				binn_list_add_uint32(data, entities.dense[i]);
+				binn_list_add_float(data, components.positionX[i]);
+				binn_list_add_float(data, components.positionY[i]);
+				binn_list_add_float(data, components.speedX[i]);
+				binn_list_add_float(data, components.speedY[i]);
+				binn_list_add_uint8(data, components.color[i].r);
+				binn_list_add_uint8(data, components.color[i].g);
+				binn_list_add_uint8(data, components.color[i].b);
+
+				benchmark_commit_binn(data, false);
+			}
+		}
+
+		inline static void benchmark_pack_move(uint32_t count) {
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			for (uint32_t i = 0; i < count; i++) {
+				if (settings.serializer == NET_SERIALIZER_PACKED) {
+					uint8_t* buffer = packet_list_reserve(&benchmark.packets, PACKED_MOVE_SIZE);
+
+					if (buffer == NULL)
+						return;
+
+					packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE);
+					packed_write_uint32(buffer, PACKED_MOVE_ENTITY, entities.dense[i]);
+					packed_write_float(buffer, PACKED_MOVE_POSITION_X, components.positionX[i]);
+					packed_write_float(buffer, PACKED_MOVE_POSITION_Y, components.positionY[i]);
+					packed_write_float(buffer, PACKED_MOVE_SPEED_X, components.speedX[i]);
+					packed_write_float(buffer, PACKED_MOVE_SPEED_Y, components.speedY[i]);
+					packet_list_commit(&benchmark.packets, PACKED_MOVE_SIZE);
+
+					continue;
+				}
+
+				binn* data = binn_list();
+
+				binn_list_add_uint8(data, NET_MESSAGE_MOVE);
+				binn_list_add_uint32(data, entities.dense[i]);
+				binn_list_add_float(data, components.positionX[i]);
+				binn_list_add_float(data, components.positionY[i]);
+				binn_list_add_float(data, components.speedX[i]);
+				binn_list_add_float(data, components.speedY[i]);
+
+				benchmark_commit_binn(data, false);
+			}
+		}
+
+		// Batches are cut by the same payload limits as on the server, with an empty stamp at the end
+		inline static void benchmark_pack_move_batch(uint32_t count) {
+			uint32_t capacity = (settings.batchSize > 0) ? settings.batchSize : UINT16_MAX;
+
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			if (settings.maxPayload > PACKED_BATCH_ENTRIES + PACKED_BATCH_ENTRY_SIZE && capacity > (settings.maxPayload - PACKED_BATCH_ENTRIES) / PACKED_BATCH_ENTRY_SIZE)
+				capacity = (settings.maxPayload - PACKED_BATCH_ENTRIES) / PACKED_BATCH_ENTRY_SIZE;
+
+			for (uint32_t i = 0; i < count; i += capacity) {
+				uint32_t entries = (count - i < capacity) ? count - i : capacity;
+
+				if (settings.serializer == NET_SERIALIZER_PACKED) {
+					size_t length = PACKED_BATCH_ENTRIES + entries * PACKED_BATCH_ENTRY_SIZE;
+					uint8_t* buffer = packet_list_reserve(&benchmark.packets, length + PACKED_STAMP_SIZE);
+
+					if (buffer == NULL)
+						return;
+
+					uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+					packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_BATCH);
+					packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+
+					for (uint32_t j = i; j < i + entries; j++, entry += PACKED_BATCH_ENTRY_SIZE) {
+						packed_write_uint32(entry, PACKED_BATCH_ENTRY_ENTITY, entities.dense[j]);
+						packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_X, components.positionX[j]);
+						packed_write_float(entry, PACKED_BATCH_ENTRY_POSITION_Y, components.positionY[j]);
+						packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_X, components.speedX[j]);
+						packed_write_float(entry, PACKED_BATCH_ENTRY_SPEED_Y, components.speedY[j]);
+					}
+
+					memset(buffer + length, 0, PACKED_STAMP_SIZE);
+					packet_list_commit(&benchmark.packets, length + PACKED_STAMP_SIZE);
+
+					continue;
+				}
+
+				binn* data = binn_list();
+
+				binn_list_add_uint8(data, NET_MESSAGE_MOVE_BATCH);
+
+				for (uint32_t j = i; j < i + entries; j++) {
+					binn_list_add_uint32(data, entities.dense[j]);
+					binn_list_add_float(data, components.positionX[j]);
+					binn_list_add_float(data, components.positionY[j]);
+					binn_list_add_float(data, components.speedX[j]);
+					binn_list_add_float(data, components.speedY[j]);
+				}
+
+				benchmark_commit_binn(data, true);
+			}
+		}
+
+		// Quantized batches use the bit widths of the server and address the populated world by index like it does
+		inline static void benchmark_pack_move_quantized(uint32_t count) {
+			uint32_t positionBits = (settings.positionBits > 0) ? settings.positionBits : 16;
+			uint32_t entryBits = (positionBits + settings.speedBits) * 2 + 1;
+			uint32_t capacity = (settings.batchSize > 0) ? settings.batchSize : UINT16_MAX;
+			float minimumX = -textureWidth, maximumX = settings.resolutionWidth + textureWidth;
+			float minimumY = -textureHeight, maximumY = settings.resolutionHeight + textureHeight;
+
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			if (settings.maxPayload > PACKED_QUANTIZED_ENTRIES && capacity > ((settings.maxPayload - PACKED_QUANTIZED_ENTRIES) * 8) / entryBits)
+				capacity = ((settings.maxPayload - PACKED_QUANTIZED_ENTRIES) * 8) / entryBits;
+
+			if (capacity == 0)
+				capacity = 1;
+
+			for (uint32_t i = 0; i < count; i += capacity) {
+				uint32_t entries = (count - i < capacity) ? count - i : capacity;
+				uint8_t* buffer = packet_list_reserve(&benchmark.packets, PACKED_QUANTIZED_ENTRIES + ((size_t)entries * entryBits + 7) / 8 + PACKED_STAMP_SIZE);
+
+				if (buffer == NULL)
+					return;
+
+				BitWriter writer = { buffer, PACKED_QUANTIZED_ENTRIES };
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_QUANTIZED);
+				packed_write_uint32(buffer, PACKED_QUANTIZED_FIRST, i);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_COUNT, (uint16_t)entries);
+				packed_write_uint8(buffer, PACKED_QUANTIZED_POSITION_BITS, (uint8_t)positionBits);
+				packed_write_uint8(buffer, PACKED_QUANTIZED_SPEED_BITS, settings.speedBits);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_WIDTH, settings.resolutionWidth);
+				packed_write_uint16(buffer, PACKED_QUANTIZED_HEIGHT, settings.resolutionHeight);
+
+				for (uint32_t j = i; j < i + entries; j++) {
+					packed_write_bits(&writer, 1, 1);
+					packed_write_bits(&writer, quantize(components.positionX[j], minimumX, maximumX, positionBits), positionBits);
+					packed_write_bits(&writer, quantize(components.positionY[j], minimumY, maximumY, positionBits), positionBits);
+					packed_write_bits(&writer, quantize(components.speedX[j], -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, settings.speedBits), settings.speedBits);
+					packed_write_bits(&writer, quantize(components.speedY[j], -NET_QUANTIZATION_SPEED_RANGE, NET_QUANTIZATION_SPEED_RANGE, settings.speedBits), settings.speedBits);
+				}
+
+				size_t length = packed_flush_bits(&writer);
+
+				memset(buffer + length, 0, PACKED_STAMP_SIZE);
+				packet_list_commit(&benchmark.packets, length + PACKED_STAMP_SIZE);
+			}
+		}
+
+		// A single absolute snapshot, the same one a client gets before it has acknowledged any
+		inline static void benchmark_pack_move_delta(uint32_t count) {
+			uint32_t capacity = (settings.batchSize > 0) ? settings.batchSize : UINT16_MAX;
+
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			for (uint32_t i = 0; i < count;) {
+				uint8_t* buffer = packet_list_reserve(&benchmark.packets, settings.maxPayload + PACKED_DELTA_ENTRIES + PACKED_DELTA_ENTRY_MAX_SIZE + PACKED_STAMP_SIZE);
+				size_t offset = PACKED_DELTA_ENTRIES;
+				uint32_t first = i;
+
+				if (buffer == NULL)
+					return;
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_MOVE_DELTA);
+				packed_write_uint32(buffer, PACKED_DELTA_SEQUENCE, 1);
+				packed_write_uint32(buffer, PACKED_DELTA_BASELINE, 0);
+				packed_write_uint32(buffer, PACKED_DELTA_TOTAL, count);
+				packed_write_uint32(buffer, PACKED_DELTA_FIRST, first);
+
+				do {
+					packed_write_uint8(buffer, offset++, PACKED_DELTA_FLAG_ABSOLUTE | PACKED_DELTA_FLAG_SPEED | PACKED_DELTA_FLAG_COLOR);
+
+					offset = packed_write_varint(buffer, offset, (int32_t)lroundf(components.positionX[i] * NET_SNAPSHOT_PRECISION));
+					offset = packed_write_varint(buffer, offset, (int32_t)lroundf(components.positionY[i] * NET_SNAPSHOT_PRECISION));
+
+					packed_write_float(buffer, offset, components.speedX[i]);
+					packed_write_float(buffer, offset + 4, components.speedY[i]);
+					packed_write_uint8(buffer, offset + 8, components.color[i].r);
+					packed_write_uint8(buffer, offset + 9, components.color[i].g);
+					packed_write_uint8(buffer, offset + 10, components.color[i].b);
+
+					offset += 11;
+				} while (++i < count && i - first < capacity && offset + PACKED_DELTA_ENTRY_MAX_SIZE <= settings.maxPayload);
+
+				packed_write_uint16(buffer, PACKED_DELTA_COUNT, (uint16_t)(i - first));
+				memset(buffer + offset, 0, PACKED_STAMP_SIZE);
+				packet_list_commit(&benchmark.packets, offset + PACKED_STAMP_SIZE);
+			}
+		}
+
+		// Batches are cut by the entry capacity of a stream chunk, the binn ones with the same number of entries
+		inline static void benchmark_pack_spawn_batch(uint32_t count) {
+			uint32_t capacity = (settings.streamChunkSize - PACKED_BATCH_ENTRIES) / PACKED_SPAWN_BATCH_ENTRY_SIZE;
+
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			for (uint32_t i = 0; i < count; i += capacity) {
+				uint32_t entries = (count - i < capacity) ? count - i : capacity;
+
+				if (settings.serializer == NET_SERIALIZER_PACKED) {
+					size_t length = PACKED_BATCH_ENTRIES + entries * PACKED_SPAWN_BATCH_ENTRY_SIZE;
+					uint8_t* buffer = packet_list_reserve(&benchmark.packets, length);
+
+					if (buffer == NULL)
+						return;
+
+					uint8_t* entry = buffer + PACKED_BATCH_ENTRIES;
+
+					packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_SPAWN_BATCH);
+					packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)entries);
+
+					for (uint32_t j = i; j < i + entries; j++, entry += PACKED_SPAWN_BATCH_ENTRY_SIZE) {
+						packed_write_uint32(entry, PACKED_SPAWN_BATCH_ENTRY_ENTITY, entities.dense[j]);
+						packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_X, components.positionX[j]);
+						packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_POSITION_Y, components.positionY[j]);
+						packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_X, components.speedX[j]);
+						packed_write_float(entry, PACKED_SPAWN_BATCH_ENTRY_SPEED_Y, components.speedY[j]);
+						packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_R, components.color[j].r);
+						packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_G, components.color[j].g);
+						packed_write_uint8(entry, PACKED_SPAWN_BATCH_ENTRY_COLOR_B, components.color[j].b);
+					}
+
+					packet_list_commit(&benchmark.packets, length);
+
+					continue;
+				}
+
+				binn* data = binn_list();
+
+				binn_list_add_uint8(data, NET_MESSAGE_SPAWN_BATCH);
+
+				for (uint32_t j = i; j < i + entries; j++) {
+					binn_list_add_uint32(data, entities.dense[j]);
+					binn_list_add_float(data, components.positionX[j]);
+					binn_list_add_float(data, components.positionY[j]);
+					binn_list_add_float(data, components.speedX[j]);
+					binn_list_add_float(data, components.speedY[j]);
+					binn_list_add_uint8(data, components.color[j].r);
+					binn_list_add_uint8(data, components.color[j].g);
+					binn_list_add_uint8(data, components.color[j].b);
+				}
+
+				benchmark_commit_binn(data, false);
+			}
+		}
+
+		// The handles of the populated world are consecutive, so it is destroyed by as few ranges as the server would send
+		inline static void benchmark_pack_destroy_range(uint32_t count) {
+			benchmark.packets.size = 0;
+			benchmark.packets.count = 0;
+
+			if (settings.serializer == NET_SERIALIZER_PACKED) {
+				uint32_t ranges = (count + UINT16_MAX - 1) / UINT16_MAX;
+				size_t length = PACKED_BATCH_ENTRIES + ranges * PACKED_DESTROY_RANGE_SIZE;
+				uint8_t* buffer = packet_list_reserve(&benchmark.packets, length);
+
+				if (buffer == NULL)
+					return;
+
+				packed_write_uint8(buffer, PACKED_HEADER_ID, NET_MESSAGE_DESTROY_RANGE);
+				packed_write_uint16(buffer, PACKED_BATCH_COUNT, (uint16_t)ranges);
+
+				for (uint32_t i = 0; i < ranges; i++) {
+					uint8_t* entry = buffer + PACKED_BATCH_ENTRIES + i * PACKED_DESTROY_RANGE_SIZE;
+					uint32_t first = i * UINT16_MAX;
+
+					packed_write_uint32(entry, PACKED_DESTROY_RANGE_FIRST, entities.dense[first]);
+					packed_write_uint16(entry, PACKED_DESTROY_RANGE_COUNT, (uint16_t)((count - first < UINT16_MAX) ? count - first : UINT16_MAX));
+				}
+
+				packet_list_commit(&benchmark.packets, length);
+
+				return;
+			}
+
+			binn* data = binn_list();
+
+			binn_list_add_uint8(data, NET_MESSAGE_DESTROY_RANGE);
+
+			for (uint32_t first = 0; first < count; first += UINT16_MAX) {
+				binn_list_add_uint32(data, entities.dense[first]);
+				binn_list_add_uint32(data, (count - first < UINT16_MAX) ? count - first : UINT16_MAX);
+			}
+
+			benchmark_commit_binn(data, false);
+		}
+
+		inline static void benchmark_restore(uint32_t count) {
+			benchmark_populate(count);
+		}
+
+		inline static void benchmark_decode(uint32_t count) {
+			uint8_t* data = benchmark.packets.data;
+
+			for (uint32_t i = 0; i < benchmark.packets.count; i++) {
+				message_receive(NULL, data, benchmark.packets.lengths[i]);
+
+				data += benchmark.packets.lengths[i];
+			}
+		}
+
+		inline static void benchmark_interpolate(uint32_t count) {
+			interpolationClock += 1.0 / 60.0;
+
+			entity_interpolate(0, count, NET_MAX_ENTITY_SPEED);
+		}
+
+		static const BenchmarkCase benchmarkCases[] = {
+			{ "decode_spawn_binn", NET_SERIALIZER_BINN, benchmark_pack_spawn, benchmark_decode, NULL },
+			{ "decode_spawn_packed", NET_SERIALIZER_PACKED, benchmark_pack_spawn, benchmark_decode, NULL },
+			{ "decode_move_binn", NET_SERIALIZER_BINN, benchmark_pack_move, benchmark_decode, NULL },
+			{ "decode_move_packed", NET_SERIALIZER_PACKED, benchmark_pack_move, benchmark_decode, NULL },
+			{ "decode_move_batch_binn", NET_SERIALIZER_BINN, benchmark_pack_move_batch, benchmark_decode, NULL },
+			{ "decode_move_batch_packed", NET_SERIALIZER_PACKED, benchmark_pack_move_batch, benchmark_decode, NULL },
+			{ "decode_move_quantized", NET_SERIALIZER_PACKED, benchmark_pack_move_quantized, benchmark_decode, NULL },
+			{ "decode_move_delta", NET_SERIALIZER_PACKED, benchmark_pack_move_delta, benchmark_decode, NULL },
+			{ "decode_spawn_batch_binn", NET_SERIALIZER_BINN, benchmark_pack_spawn_batch, benchmark_decode, NULL },
+			{ "decode_spawn_batch_packed", NET_SERIALIZER_PACKED, benchmark_pack_spawn_batch, benchmark_decode, NULL },
+			{ "decode_destroy_range_binn", NET_SERIALIZER_BINN, benchmark_pack_destroy_range, benchmark_decode, benchmark_restore },
+			{ "decode_destroy_range_packed", NET_SERIALIZER_PACKED, benchmark_pack_destroy_range, benchmark_decode, benchmark_restore }
+		};
+	#endif
+
+	inline static uint32_t benchmark_kernels(BenchmarkKernel* kernels) {
+		uint32_t count = 0;
+
+		kernels[count++] = (BenchmarkKernel){ "scalar", entity_move_scalar };
+
+		#ifdef SIMD_X86
+			kernels[count++] = (BenchmarkKernel){ "sse", entity_move_sse };
+
+			if (simd_avx2_supported())
+				kernels[count++] = (BenchmarkKernel){ "avx2", entity_move_avx2 };
+		#elif defined(SIMD_NEON)
+			kernels[count++] = (BenchmarkKernel){ "neon", entity_move_neon };
+		#endif
+
+		return count;
+	}
+
+	inline static int benchmark_compare(const void* a, const void* b) {
+		uint64_t left = *(const uint64_t*)a, right = *(const uint64_t*)b;
+
+		return (left > right) - (left < right);
+	}
+
+	// Warm-up repetitions fill the pools and caches, the reported bytes are those of the last repetition
+	inline static void benchmark_measure(const char* name, BenchmarkFunction reset, BenchmarkFunction run, uint32_t count) {
+		uint64_t bytes = 0;
+
+		for (uint32_t i = 0; i < settings.benchmarkWarmup; i++) {
+			if (reset != NULL)
+				reset(count);
+
+			arena_reset();
+			run(count);
+			benchmark_bytes();
+		}
+
+		// Each repetition stands for a frame, so the arena starts over like it does at the top of the loop
+		for (uint32_t i = 0; i < settings.benchmarkRepetitions; i++) {
+			uint64_t startTime = 0, endTime = 0;
+
+			if (reset != NULL)
+				reset(count);
+
+			arena_reset();
+			aws_high_res_clock_get_ticks(&startTime);
+			run(count);
+			aws_high_res_clock_get_ticks(&endTime);
+
+			benchmark.samples[i] = endTime - startTime;
+			bytes = benchmark_bytes();
+		}
+
+		qsort(benchmark.samples, settings.benchmarkRepetitions, sizeof(uint64_t), benchmark_compare);
+
+		uint64_t minimum = benchmark.samples[0];
+		uint64_t median = benchmark.samples[settings.benchmarkRepetitions / 2];
+		uint64_t maximum = benchmark.samples[settings.benchmarkRepetitions - 1];
+
+		fprintf(benchmark.file, "%s,%u,%u,%.3f,%.3f,%.3f,%.2f,%llu\n", name, count, settings.benchmarkRepetitions, minimum / 1000000.0, median / 1000000.0, maximum / 1000000.0, (double)median / count, (unsigned long long)bytes);
+		fflush(benchmark.file);
+	}
+
+	inline static const char* benchmark_run(void) {
+		benchmark.file = (settings.benchmarkFile != NULL) ? fopen(settings.benchmarkFile, "w") : stdout;
+
+		free(settings.benchmarkFile);
+
+		if (benchmark.file == NULL)
+			return "Benchmark file creation failed";
+
+		if ((benchmark.samples = (uint64_t*)je_malloc(sizeof(uint64_t) * settings.benchmarkRepetitions)) == NULL)
+			return "Benchmark samples allocation failed";
+
+		BenchmarkKernel kernels[BENCHMARK_MAX_KERNELS];
+		uint32_t kernelCount = benchmark_kernels(kernels);
+		uint8_t serializer = settings.serializer;
+		const char* benchmarkError = NULL;
+
+		fputs("case,entities,repetitions,minimum_ms,median_ms,maximum_ms,median_ns_per_entity,bytes\n", benchmark.file);
+
+		// A single virtual peer, so broadcasts are encoded and counted once
+		#ifdef NETDYNAMICS_SERVER
+			connected = 1;
+		#endif
+
+		for (uint32_t i = 0; i < BENCHMARK_SIZES && benchmarkError == NULL; i++) {
+			uint32_t count = benchmarkSizes[i];
+
+			for (uint32_t j = 0; j < sizeof(benchmarkCases) / sizeof(BenchmarkCase); j++) {
+				const BenchmarkCase* benchmarkCase = &benchmarkCases[j];
+
+				if (!benchmark_populate(count)) {
+					benchmarkError = string_entities_failed;
+
+					break;
+				}
+
+				settings.serializer = benchmarkCase->serializer;
+
+				if (benchmarkCase->prepare != NULL)
+					benchmarkCase->prepare(count);
+
+				benchmark_measure(benchmarkCase->name, benchmarkCase->reset, benchmarkCase->run, count);
+			}
+
+			for (uint32_t j = 0; j < kernelCount && benchmarkError == NULL; j++) {
+				char name[32];
+
+				if (!benchmark_populate(count)) {
+					benchmarkError = string_entities_failed;
+
+					break;
+				}
+
+				snprintf(name, sizeof(name), "move_%s", kernels[j].name);
+
+				benchmark.kernel = kernels[j].kernel;
+
+				benchmark_measure(name, NULL, benchmark_move, count);
+			}
+
+			#ifdef NETDYNAMICS_CLIENT
+				if (benchmarkError == NULL && components.samples != NULL && benchmark_populate(count))
+					benchmark_measure("interpolate", NULL, benchmark_interpolate, count);
+			#endif
+		}
+
+		settings.serializer = serializer;
+
+		je_free(benchmark.samples);
+		je_free(benchmark.packets.data);
+		je_free(benchmark.packets.lengths);
+
+		if (benchmark.file != stdout)
+			fclose(benchmark.file);
+		else
+			fflush(stdout);
+
+		return benchmarkError;
+	}
+#endif
+
+int main(void) {
+	// Settings
+
+	// Zero is a valid channel, so the map gets its defaults before parsing
+	for (uint8_t i = 0; i < NET_CHANNELS; i++) {
+		settings.channels[i] = i;
+	}
+
+	if (ini_parse("settings.ini", ini_callback, &settings) < 0)
+		abort();
+
+	for (uint8_t i = 0; i < NET_CHANNELS; i++) {
+		if (settings.channels[i] >= NET_MAX_CHANNELS)
+			settings.channels[i] = NET_MAX_CHANNELS - 1;
+	}
+
+	// Replays run headless and as fast as the systems go
+	if (settings.replay != NULL) {
+		settings.headlessMode = 1;
+		settings.transport = NET_TRANSPORT_REPLAY;
+	}
+
+	// Benchmarks drive the systems directly, so nothing is sent, simulated or recorded
+	#ifdef NETDYNAMICS_BENCHMARK
+		settings.headlessMode = 1;
+		settings.transport = NET_TRANSPORT_NULL;
+		settings.simulation = 0;
+		settings.networkThread = 0;
+		settings.loadClients = 1;
+
+		free(settings.captureFile);
+
+		settings.captureFile = NULL;
+	#endif
+
+	// Main
+
+	char* title = NULL;
+
+	#ifdef NETDYNAMICS_SERVER
+		title = "NetDynamics (Server)";
+	#elif NETDYNAMICS_CLIENT
+		title = "NetDynamics (Client)";
+
+	#endif
+
+	if (settings.headlessMode) {
+		static struct aws_allocator allocator;
+
+		aws_common_library_init(&allocator);
+	} else {
+		if (settings.vsync > 0)
+			RaySetConfigFlags(FLAG_VSYNC_HINT);
+
+		RayInitWindow((int)settings.resolutionWidth, (int)settings.resolutionHeight, title);
+		RaySetTargetFPS((int)settings.framerateLimit);
+
+		font = RayLoadFontEx("share_tech.ttf", fontSize, 0, 0);
+
+		RaySetTextureFilter(font.texture, FILTER_POINT);
+	}
+
+	// Systems
+
+	simd_initialize(settings.kernel);
+
+	uint64_t seed = 0;
+
+	aws_high_res_clock_get_ticks(&seed);
+	random_seed(seed);
+
+	#ifdef NETDYNAMICS_SERVER
+		if (settings.scenario != NULL && !scenario_load(settings.scenario))
+			error = "Scenario loading failed";
+	#endif
+
+	free(settings.scenario);
+
+	if (settings.arena > 0) {
+		#ifdef NETDYNAMICS_SERVER
+			uint32_t count = ((settings.workers < NET_MAX_WORKERS) ? settings.workers : NET_MAX_WORKERS) + 1;
+		#elif NETDYNAMICS_CLIENT
+			uint32_t count = 1;
+		#endif
+
+		if (!arena_create(count))
+			error = "Arena creation failed";
+	}
+
+	#ifdef NETDYNAMICS_SERVER
+		if (!job_pool_start(settings.workers))
+			error = "Worker threads creation failed";
+	#endif
+
+	// Benchmark
+
+	if (settings.benchmarkWarmup == 0)
+		settings.benchmarkWarmup = NET_BENCHMARK_WARMUP;
+
+	if (settings.benchmarkRepetitions == 0)
+		settings.benchmarkRepetitions = NET_BENCHMARK_REPETITIONS;
+
+	// Metrics
+
+	if (settings.metricsInterval == 0)
+		settings.metricsInterval = NET_METRICS_INTERVAL;
+
+	// Timing
+
+	if (settings.maxCatchUp == 0)
+		settings.maxCatchUp = NET_TIMING_MAX_CATCH_UP;
+
+	if (settings.tickRate > 0)
+		timing.tickInterval = 1.0f / settings.tickRate;
+
+	// Interpolation
+
+	if (settings.extrapolationLimit == 0)
+		settings.extrapolationLimit = NET_EXTRAPOLATION_LIMIT;
+
+	if (!metrics_open())
+		error = "Metrics file creation failed";
+
+	free(settings.metricsFile);
+
+	// Capture
+
+	if (!capture_open())
+		error = "Capture file creation failed";
+
+	free(settings.captureFile);
+
+	// Serialization
+
+	if (settings.arena > 0)
+		binn_set_alloc_functions(arena_malloc, arena_realloc, arena_free);
+	else
+		binn_set_alloc_functions(je_malloc, je_realloc, je_free);
+
+	if (settings.redundantBytes > 0) {
+		if (settings.redundantBytes > sizeof(redundancyBuffer))
+			settings.redundantBytes = (uint32_t)sizeof(redundancyBuffer);
+
+		for (uint32_t i = 0; i < settings.redundantBytes; i++) {
+			redundancyBuffer[i] = i % sizeof(uint8_t);
+		}
+	}
+
+	if (settings.maxPayload == 0)
+		settings.maxPayload = NET_BATCH_PAYLOAD;
+
+	if (settings.positionBits > NET_QUANTIZATION_MAX_POSITION_BITS)
+		settings.positionBits = NET_QUANTIZATION_MAX_POSITION_BITS;
+
+	if (settings.speedBits == 0)
+		settings.speedBits = NET_QUANTIZATION_SPEED_BITS;
+	else if (settings.speedBits > NET_QUANTIZATION_MAX_SPEED_BITS)
+		settings.speedBits = NET_QUANTIZATION_MAX_SPEED_BITS;
+
+	// Interest
+
+	if (settings.cellSize == 0)
+		settings.cellSize = NET_INTEREST_CELL_SIZE;
+
+	if (settings.viewWidth == 0)
+		settings.viewWidth = settings.resolutionWidth - settings.viewX;
+
+	if (settings.viewHeight == 0)
+		settings.viewHeight = settings.resolutionHeight - settings.viewY;
+
+	// Scheduler
+
+	if (settings.budget == 0)
+		settings.budget = NET_SCHEDULER_BUDGET;
+
+	// Stream
+
+	if (settings.streamChunkSize == 0)
+		settings.streamChunkSize = NET_STREAM_CHUNK_SIZE;
+
+	if (settings.streamChunkSize > NET_STREAM_MAX_CHUNK_SIZE)
+		settings.streamChunkSize = NET_STREAM_MAX_CHUNK_SIZE;
+
+	if (settings.streamChunkSize < PACKED_BATCH_ENTRIES + PACKED_SPAWN_BATCH_ENTRY_SIZE + settings.redundantBytes)
+		settings.streamChunkSize = PACKED_BATCH_ENTRIES + PACKED_SPAWN_BATCH_ENTRY_SIZE + settings.redundantBytes;
+
+	if (settings.streamChunks == 0)
+		settings.streamChunks = NET_STREAM_CHUNKS;
+
+	// Channels
+
+	if (settings.controlPayload == 0)
+		settings.controlPayload = NET_STREAM_CHUNK_SIZE;
+
+	if (settings.controlPayload > NET_STREAM_MAX_CHUNK_SIZE)
+		settings.controlPayload = NET_STREAM_MAX_CHUNK_SIZE;
+
+	if (settings.controlPayload < PACKED_BATCH_ENTRIES + PACKED_SPAWN_BATCH_ENTRY_SIZE + settings.redundantBytes)
+		settings.controlPayload = PACKED_BATCH_ENTRIES + PACKED_SPAWN_BATCH_ENTRY_SIZE + settings.redundantBytes;
+
+	// Compression
+
+	if (settings.compressionThreshold == 0)
+		settings.compressionThreshold = NET_COMPRESSION_THRESHOLD;
+
+	if (settings.compressionLevel == 0)
+		settings.compressionLevel = NET_COMPRESSION_LEVEL;
+
+	// The codecs are only linked into builds that ask for them
+	#ifndef NETDYNAMICS_COMPRESSION
+		if (settings.compression > NET_COMPRESSION_NONE) {
+			settings.compression = NET_COMPRESSION_NONE;
+			error = "Compression is not available in this build";
+		}
+	#endif
+
+	// Load
+
+	if (settings.loadClients == 0)
+		settings.loadClients = 1;
+	else if (settings.loadClients > NET_MAX_LOAD_CLIENTS)
+		settings.loadClients = NET_MAX_LOAD_CLIENTS;
+
+	// Hosts of the load generator are multiplexed on the main thread
+	if (settings.loadClients > 1)
+		settings.networkThread = 0;
+
+	if (settings.transport == NET_TRANSPORT_REPLAY) {
+		settings.loadClients = 1;
+		settings.networkThread = 0;
+	}
+
+	if (!packet_pool_create())
+		error = "Packet pool creation failed";
+
+	// Network
+
+	if (settings.transport >= sizeof(transports) / sizeof(Transport)) {
+		transport = &transports[NET_TRANSPORT_HYPERNET];
+		error = "Set the correct number of a network transport";
+	} else {
+		transport = &transports[settings.transport];
+
+		if (settings.simulation > 0 && settings.transport != NET_TRANSPORT_REPLAY)
+			transport = conditioner_wrap(transport);
+
+		const char* transportError = transport->initialize();
+
+		if (transportError == NULL)
+			transportError = transport->connect();
+
+		if (transportError != NULL)
+			error = transportError;
+	}
+
+	const char* name = transport->name;
+
+	free(settings.ip);
+
+	// Data
+
+	if (error == NULL) {
+		if (!entities_reserve(NET_ENTITY_CAPACITY))
+			error = string_entities_failed;
+
+		#ifdef NETDYNAMICS_SERVER
+			if (settings.interest > 0 && !interest_create())
+				error = "Interest grid creation failed";
+		#endif
+
+		if (!settings.headlessMode)
+			texture = RayLoadTexture("neon_circle.png");
+	}
+
+	#ifdef NETDYNAMICS_BENCHMARK
+		if (error == NULL) {
+			const char* benchmarkError = benchmark_run();
+
+			if (benchmarkError != NULL)
+				fprintf(stderr, "ERROR %s\n", benchmarkError);
+		} else {
+			fprintf(stderr, "ERROR %s (%s)\n", error, name);
+		}
+	#else
+
+	#ifdef NETDYNAMICS_SERVER
+		float sendInterval = 1.0f / settings.sendRate;
+	#elif NETDYNAMICS_CLIENT
+		uint32_t rtt = 0;
+	#endif
+
+	while (settings.headlessMode || !RayWindowShouldClose()) {
+		arena_reset();
+
+		float deltaTime = get_frame_time();
+		uint64_t tickTime = metrics_ticks();
+
+		#ifdef NETDYNAMICS_CLIENT
+			interpolationClock += deltaTime;
+		#endif
+
+		if (error == NULL) {
+			// Scenario
+			#ifdef NETDYNAMICS_SERVER
+				if (!scenario_update(deltaTime))
+					break;
+
+				sendInterval = 1.0f / settings.sendRate;
+			#endif
+
+			// Transport
+			uint64_t pollTime = profiler_ticks();
+
+			TransportEvent event;
+
+			while (transport->poll(&event)) {
+				capture_record(event.type, event.peerID, event.reliable, event.data, event.length);
+
+				switch (event.type) {
+					case TRANSPORT_EVENT_CONNECT: {
+						#ifdef NETDYNAMICS_SERVER
+							connected = transport->connections();
+							clients[event.peerID] = event.peer;
+							acknowledged[event.peerID] = 0;
+							views[event.peerID] = (Rectangle){ 0 };
+
+							if (components.priority != NULL) {
+								for (uint32_t i = 0; i < entities.count; i++) {
+									components.priority[i * NET_MAX_CLIENTS + event.peerID] = 0.0f;
+								}
+							}
+
+							stream_start(event.peerID);
+						#elif NETDYNAMICS_CLIENT
+							connected = true;
+							status = string_connected;
+
+							message_send(event.peer, NET_MESSAGE_VIEW, NULL);
+						#endif
+
+						break;
+					}
+
+					case TRANSPORT_EVENT_DISCONNECT: {
+						#ifdef NETDYNAMICS_SERVER
+							connected = transport->connections();
+							clients[event.peerID] = NULL;
+
+							stream_stop(event.peerID);
+						#elif NETDYNAMICS_CLIENT
+							connected = false;
+							worstLag = 0.0f;
+							status = string_disconnected;
+
+							entity_flush();
+							latency_reset();
+						#endif
+
+						break;
+					}
+
+					case TRANSPORT_EVENT_RECEIVE: {
+						uint64_t decodeTime = profiler_ticks();
+
+						metrics_received(event.length);
+
+						uint8_t id = message_receive(event.peer, event.data, event.length);
+
+						profiler_record(PROFILER_DECODE, decodeTime);
+
+						#ifdef NETDYNAMICS_SERVER
+							if (id == NET_MESSAGE_SPAWN)
+								replication_spawned();
+						#endif
+
+						break;
+					}
+				}
+
+				transport->release(&event);
+			}
+
+			#ifdef NETDYNAMICS_CLIENT
+				TransportStats stats = { 0 };
+
+				if (transport->stats(NULL, &stats))
+					rtt = latency.rtt = stats.rtt;
+			#endif
+
+			profiler_record(PROFILER_POLL, pollTime);
+
+			// Timer
+			uint32_t ticks = timing_ticks(deltaTime);
+			float stepTime = timing_step(deltaTime);
+
+			#ifdef NETDYNAMICS_SERVER
+				static float sendTime = 0.0f;
+
+				sendTime += ticks * stepTime;
+			#endif
+
+			// Stream
+			#ifdef NETDYNAMICS_SERVER
+				if (connected > 0 && channel_due(NET_CHANNEL_BULK, deltaTime)) {
+					uint64_t streamTime = profiler_ticks();
+
+					stream_update();
+
+					profiler_record(PROFILER_SEND, streamTime);
+				}
+			#endif
+
+			// Spawn
+			if (!settings.headlessMode) {
+				if (RayIsMouseButtonDown(MOUSE_LEFT_BUTTON) || RayIsKeyPressed(KEY_SPACE)) {
+					#ifdef NETDYNAMICS_SERVER
+						world_spawn(RayGetMousePosition(), NET_MAX_ENTITY_SPAWN);
+					#elif NETDYNAMICS_CLIENT
+						if (connected) {
+							transport->flush();
+
+							message_send(NULL, NET_MESSAGE_SPAWN, NULL);
+						}
+					#endif
+				}
+			}
+
+			// Move
+			if (ENTITIES_EXIST()) {
+				uint64_t moveTime = profiler_ticks();
+
+				#ifdef NETDYNAMICS_CLIENT
+					if (components.samples != NULL)
+						entity_interpolate(0, entities.count, NET_MAX_ENTITY_SPEED);
+				#endif
+
+				for (uint32_t i = 0; i < ticks && components.samples == NULL; i++) {
+					moveKernel(0, entities.count, NET_MAX_ENTITY_SPEED, stepTime);
+				}
+
+				profiler_record(PROFILER_MOVE, moveTime);
+
+				#ifdef NETDYNAMICS_SERVER
+					if (connected > 0) {
+						if (sendTime >= sendInterval) {
+							sendTime -= sendInterval;
+
+							transport->flush();
+							packed_stamp_update();
+
+							uint64_t serializeTime = profiler_ticks();
+
+							if (settings.deltaCompression > 0 && snapshot_reserve(entities.capacity)) {
+								snapshot_capture();
+
+								for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+									if (clients[i] != NULL)
+										message_send_delta(clients[i], acknowledged[i]);
+								}
+
+								snapshot++;
+							} else if ((settings.interest > 0 && interest_update()) || (settings.scheduler > 0 && components.priority != NULL)) {
+								updates = 0;
+
+								for (uint32_t i = 0; i < NET_MAX_CLIENTS; i++) {
+									if (clients[i] != NULL) {
+										uint32_t* slots = (settings.interest > 0) ? interestGrid.gather : scheduler_candidates();
+										uint32_t count = (settings.interest > 0) ? interest_gather(&views[i]) : entities.count;
+
+										if (slots == NULL)
+											break;
+
+										if (settings.scheduler > 0)
+											count = scheduler_select(i, slots, count, &views[i], sendInterval);
+
+										message_send_batch(clients[i], slots, count);
+
+										updates += count;
+									}
+								}
+							} else if (settings.batchSize > 0) {
+								message_send_batch_to_all(0, entities.indices);
+							} else {
+								for (uint32_t i = 0; i < entities.count; i++) {
+									message_send_to_all(NET_MESSAGE_MOVE, &entities.dense[i]);
+								}
+							}
+
+							profiler_record(PROFILER_SEND, serializeTime);
+						}
+					}
+				#endif
+			}
+
+			// Load
+			#ifdef NETDYNAMICS_CLIENT
+				if (settings.loadClients > 1)
+					load_update(deltaTime);
+			#endif
+
+			// Destroy
+			#ifdef NETDYNAMICS_SERVER
+				if (!settings.headlessMode) {
+					if (ENTITIES_EXIST()) {
+						if (RayIsMouseButtonDown(MOUSE_RIGHT_BUTTON) || RayIsKeyPressed(KEY_BACKSPACE))
+							world_destroy(NET_MAX_ENTITY_SPAWN);
+					}
+				}
+
+				if (channel_due(NET_CHANNEL_CONTROL, deltaTime))
+					replication_flush();
+			#endif
+		}
+
+		metrics_tick(tickTime);
+
+		if (!settings.headlessMode) {
+			// Render
+			uint64_t renderTime = profiler_ticks();
+
+			RayBeginDrawing();
+			RayClearBackground(CLITERAL{ 20, 0, 48, 255 });
+
+			if (error != NULL) {
+				// Error
+				RayDrawTextEx(font, RayFormatText("ERROR %s", error), (Vector2){ 10, 10 }, fontSize, 0, WHITE);
+			} else {
+				// Entities
+				if (settings.meshBatch == 0 || !ENTITIES_EXIST() || !render_batch_draw()) {
+					for (uint32_t i = 0; i < entities.count; i++) {
+						RayDrawTexture(texture, components.positionX[i], components.positionY[i], components.color[i]);
+					}
+				}
+
+				// Stats
+				static int fps = 0;
+				static int counter = 0;
+				static int refreshRate = 20;
+
+				if (counter < refreshRate) {
+					counter++;
+				} else {
+					fps = RayGetFPS();
+					refreshRate = fps;
+					counter = 0;
+				}
+
+				RayDrawTextEx(font, RayFormatText("FPS %i", fps), (Vector2){ 10, 10 }, fontSize, 0, WHITE);
+				RayDrawTextEx(font, RayFormatText("ENTITIES %u", entities.count), (Vector2){ 10, 35 }, fontSize, 0, WHITE);
+				RayDrawTextEx(font, name, (Vector2){ 10, 75 }, fontSize, 0, WHITE);
+				RayDrawTextEx(font, RayFormatText("STATUS %s", status), (Vector2){ 10, 100 }, fontSize, 0, WHITE);
+
+				#ifdef NETDYNAMICS_SERVER
+					RayDrawTextEx(font, RayFormatText("CONNECTED CLIENTS %u/%u", connected, NET_MAX_CLIENTS), (Vector2){ 10, 125 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("SEND RATE %u", settings.sendRate), (Vector2){ 10, 150 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("MESSAGES PER SECOND %u", ((settings.interest > 0 || settings.scheduler > 0) ? updates : connected * entities.count) * settings.sendRate), (Vector2){ 10, 175 }, fontSize, 0, WHITE);
+
+					#ifdef NETDYNAMICS_COMPRESSION
+						if (settings.compression > NET_COMPRESSION_NONE) {
+							size_t inputBytes = aws_atomic_load_int_explicit(&compressor.inputBytes, aws_memory_order_relaxed);
+							size_t outputBytes = aws_atomic_load_int_explicit(&compressor.outputBytes, aws_memory_order_relaxed);
+							size_t datagrams = aws_atomic_load_int_explicit(&compressor.datagrams, aws_memory_order_relaxed);
+							size_t ticks = aws_atomic_load_int_explicit(&compressor.ticks, aws_memory_order_relaxed);
+
+							RayDrawTextEx(font, RayFormatText("COMPRESSION RATIO %.2f", (outputBytes > 0) ? (float)inputBytes / outputBytes : 1.0f), (Vector2){ 10, 200 }, fontSize, 0, WHITE);
+							RayDrawTextEx(font, RayFormatText("COMPRESSION TIME %.2f us", (datagrams > 0) ? ((float)ticks / datagrams) / 1000.0f : 0.0f), (Vector2){ 10, 225 }, fontSize, 0, WHITE);
+						}
+					#endif
+
+					for (uint32_t i = 0; i < NET_CHANNELS; i++) {
+						RayDrawTextEx(font, RayFormatText("CHANNEL %u %s %u/s %.1f KB/s", settings.channels[i], channelNames[i], channelCounters[i].messageRate, channelCounters[i].byteRate / 1024.0f), (Vector2){ 10, 250 + i * 25 }, fontSize, 0, WHITE);
+					}
+				#elif NETDYNAMICS_CLIENT
+					TransportStats stats = { 0 };
+
+					transport->stats(NULL, &stats);
+
+					RayDrawTextEx(font, RayFormatText("RTT %u", rtt), (Vector2){ 10, 125 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("Packets sent %u", stats.packetsSent), (Vector2){ 10, 150 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("Packets lost %u", stats.packetsLost), (Vector2){ 10, 175 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("Packets throttle %.1f%%", stats.throttle), (Vector2){ 10, 200 }, fontSize, 0, WHITE);
+					RayDrawTextEx(font, RayFormatText("Worst lag %.2f ms", worstLag), (Vector2){ 10, 225 }, fontSize, 0, WHITE);
+
+					if (settings.loadClients > 1)
+						RayDrawTextEx(font, RayFormatText("Load clients %u/%u", loadConnected + (connected ? 1 : 0), settings.loadClients), (Vector2){ 10, 250 }, fontSize, 0, WHITE);
+
+					if (settings.latency > 0) {
+						for (uint32_t i = 0; i < LATENCY_SERIES; i++) {
+							RayDrawTextEx(font, RayFormatText("%s %.1f/%.1f/%.1f ms", latencySeries[i], latency.stats[i].median, latency.stats[i].percentile, latency.stats[i].maximum), (Vector2){ 10, 275 + i * 25 }, fontSize, 0, WHITE);
+						}
+
+						RayDrawTextEx(font, RayFormatText("Reorders %u, skipped ticks %u", latency.reorders, latency.skipped), (Vector2){ 10, 275 + LATENCY_SERIES * 25 }, fontSize, 0, WHITE);
+					}
+				#endif
+
+				// Profiler
+				if (settings.profiler > 0) {
+					int screenWidth = RayGetScreenWidth(), screenHeight = RayGetScreenHeight();
+					float scale = (screenWidth - 20) / (1000.0f / settings.framerateLimit);
+					float offset = 10.0f;
+
+					for (uint32_t i = 0; i < PROFILER_PHASES; i++) {
+						float width = profiler.stats[i].average * scale;
+
+						RayDrawRectangle((int)offset, screenHeight - 30, (int)width, 20, colors[i]);
+						RayDrawTextEx(font, RayFormatText("%s %.2f/%.2f/%.2f ms", profilerPhases[i], profiler.stats[i].minimum, profiler.stats[i].average, profiler.stats[i].percentile), (Vector2){ screenWidth - 330, 10 + i * 25 }, fontSize, 0, colors[i]);
+
+						offset += width;
+					}
+
+					if (settings.arena > 0) {
+						size_t mainPeak, workerPeak;
+						uint32_t overflows;
+
+						arena_stats(&mainPeak, &workerPeak, &overflows);
+						RayDrawTextEx(font, RayFormatText("ARENA %.1f/%.1f KB %u overflows", mainPeak / 1024.0f, workerPeak / 1024.0f, overflows), (Vector2){ screenWidth - 330, 10 + PROFILER_PHASES * 25 }, fontSize, 0, WHITE);
+					}
+
+					// The outline is the budget of a frame at the framerate limit
+					RayDrawRectangleLines(10, screenHeight - 30, screenWidth - 20, 20, WHITE);
+				}
+			}
+
+			// Ending the frame flushes the batched draws, so it is counted as rendering
+			RayEndDrawing();
+
+			profiler_record(PROFILER_RENDER, renderTime);
+		} else if (settings.transport != NET_TRANSPORT_REPLAY) {
+			timing_sleep();
+		}
+
+		profiler_frame();
+
+		if (settings.headlessMode && settings.profiler > 0 && profiler.frames % settings.framerateLimit == 0)
+			profiler_print();
+
+		#ifdef NETDYNAMICS_CLIENT
+			if (latency_update(deltaTime) && settings.headlessMode)
+				latency_print();
+		#endif
+
+		channel_update(deltaTime);
+		metrics_update();
+
+		if (replay.finished)
+			break;
+	}
+	#endif
+
+	#ifdef NETDYNAMICS_SERVER
+		scenario_report();
+		scenario_destroy();
+	#endif
+
+	transport->shutdown();
+
+	free(settings.replay);
+
+	if (error == NULL) {
+		entities_destroy();
+
+		#ifdef NETDYNAMICS_SERVER
+			interest_destroy();
+			replication_destroy();
+
+			je_free(schedulerCandidates);
+		#endif
+
+		je_free(snapshotHistory);
+
+		#ifdef NETDYNAMICS_CLIENT
+			je_free(snapshotChunks);
+		#endif
+
+		if (!settings.headlessMode) {
+			render_batch_destroy();
+			RayUnloadTexture(texture);
+		}
+	}
+
+	metrics_close();
+	capture_close();
+	job_pool_stop();
+	arena_destroy();
+	packet_pool_destroy();
+
+	if (settings.headlessMode)
+		aws_common_library_clean_up();
+	else
+		RayCloseWindow();
+}